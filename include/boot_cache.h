@@ -0,0 +1,33 @@
+#ifndef BOOT_CACHE_H
+#define BOOT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// --- Fast-Boot State Persisted in NVS ---
+// NVS (not RTC memory) so it survives brownouts and power cycles, which is
+// exactly when the shed light needs to come back quickly.
+
+struct WifiCache {
+  int32_t channel;
+  uint8_t bssid[6];
+  uint32_t ip;       // Last DHCP lease, reused only if FAST_BOOT_REUSE_LEASE
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+// Returns false if nothing valid has been cached yet
+bool load_wifi_cache(WifiCache& cache);
+// Writes only when the contents differ from what's stored (spares flash wear)
+void save_wifi_cache(const WifiCache& cache);
+void clear_wifi_cache();
+
+// Hash of the last discovery document read back from the broker
+uint32_t load_discovery_hash();
+void save_discovery_hash(uint32_t hash);
+
+// 32-bit FNV-1a
+uint32_t fnv1a_hash(const char* data, size_t length);
+
+#endif // BOOT_CACHE_H
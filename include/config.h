@@ -3,7 +3,8 @@
 
 #include <stdint.h>
 
-static const int DEVICE_DISCOVERY_PAYLOAD_SIZE = 4096; // Size of the JSON payload for MQTT Discovery
+static const int DEVICE_DISCOVERY_PAYLOAD_SIZE = 12288; // Size of the JSON payload for MQTT Discovery
+static const unsigned int MQTT_MAX_COMMAND_PAYLOAD = 32; // Longer command payloads are dropped unparsed
 
 // --- Device Configuration ---
 extern const char* DEVICE_ID;
@@ -17,6 +18,15 @@ extern const int LED_PIN; // On-board LED for PIR indication
 extern const char* WIFI_SSID;
 extern const char* WIFI_PASSWORD;
 
+// --- Fast Boot / Network ---
+extern const bool USE_STATIC_IP;             // Skip DHCP entirely with the address below
+extern const char* STATIC_IP;
+extern const char* STATIC_GATEWAY;
+extern const char* STATIC_SUBNET;
+extern const char* STATIC_DNS;
+extern const bool FAST_BOOT_REUSE_LEASE;     // Reuse the cached DHCP lease (needs a DHCP reservation)
+extern const unsigned long FAST_CONNECT_TIMEOUT_MS;
+
 // --- MQTT Broker Settings ---
 extern const char* MQTT_SERVER;
 extern const char* MQTT_USER;
@@ -30,11 +40,14 @@ extern unsigned long INITIAL_MANUAL_TIMER_DURATION_MS;
 
 // --- Device Availability ---
 extern const char* MQTT_TOPIC_DEVICE_AVAILABILITY;
+extern const char* MQTT_TOPIC_HA_STATUS; // Home Assistant birth message, triggers rediscovery
+extern const char* MQTT_TOPIC_DEVICE_DISCOVERY; // Retained device discovery document
 
 // --- Light Control ---
 extern const char* MQTT_BASE_TOPIC_LIGHT;
 extern const char* MQTT_TOPIC_LIGHT_STATE;
 extern const char* MQTT_TOPIC_LIGHT_COMMAND;
+extern const char* MQTT_TOPIC_LIGHT_ACK; // Echoes a command's sender token and the resulting relay state
 
 // --- Timers ---
 extern const char* MQTT_BASE_TOPIC_MOTION_TIMER;
@@ -46,6 +59,28 @@ extern const char* MQTT_BASE_TOPIC_MANUAL_TIMER;
 extern const char* MQTT_TOPIC_MANUAL_TIMER_STATE;
 extern const char* MQTT_TOPIC_MANUAL_TIMER_COMMAND;
 
+// --- Adaptive Sampling Bounds ---
+extern const char* MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MIN;
+extern const char* MQTT_TOPIC_CLIMATE_SAMPLE_MIN_STATE;
+extern const char* MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND;
+extern const char* MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MAX;
+extern const char* MQTT_TOPIC_CLIMATE_SAMPLE_MAX_STATE;
+extern const char* MQTT_TOPIC_CLIMATE_SAMPLE_MAX_COMMAND;
+
+extern const char* MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MIN;
+extern const char* MQTT_TOPIC_PRESSURE_SAMPLE_MIN_STATE;
+extern const char* MQTT_TOPIC_PRESSURE_SAMPLE_MIN_COMMAND;
+extern const char* MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MAX;
+extern const char* MQTT_TOPIC_PRESSURE_SAMPLE_MAX_STATE;
+extern const char* MQTT_TOPIC_PRESSURE_SAMPLE_MAX_COMMAND;
+
+extern const char* MQTT_BASE_TOPIC_LUX_SAMPLE_MIN;
+extern const char* MQTT_TOPIC_LUX_SAMPLE_MIN_STATE;
+extern const char* MQTT_TOPIC_LUX_SAMPLE_MIN_COMMAND;
+extern const char* MQTT_BASE_TOPIC_LUX_SAMPLE_MAX;
+extern const char* MQTT_TOPIC_LUX_SAMPLE_MAX_STATE;
+extern const char* MQTT_TOPIC_LUX_SAMPLE_MAX_COMMAND;
+
 // --- Sensors ---
 extern const char* MQTT_TOPIC_MOTION_STATE;
 extern const char* MQTT_TOPIC_OCCUPANCY_STATE;
@@ -54,6 +89,31 @@ extern const char* MQTT_TOPIC_HUMIDITY_SHED_STATE; // NEW
 extern const char* MQTT_TOPIC_PRESSURE_SHED_STATE; // NEW
 extern const char* MQTT_TOPIC_LUX_SHED_STATE; // NEW
 
+// --- Derived Metrics ---
+extern const char* MQTT_TOPIC_DEW_POINT_SHED_STATE;
+extern const char* MQTT_TOPIC_HEAT_INDEX_SHED_STATE;
+extern const char* MQTT_TOPIC_PRESSURE_TENDENCY_SHED_STATE;
+extern const char* MQTT_TOPIC_TEMPERATURE_24H_MIN_SHED_STATE;
+extern const char* MQTT_TOPIC_TEMPERATURE_24H_MAX_SHED_STATE;
+extern const char* MQTT_TOPIC_TEMPERATURE_24H_MEAN_SHED_STATE;
+
+// --- Sensor Availability (per entity) ---
+extern const char* MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY;
+extern const char* MQTT_TOPIC_HUMIDITY_SHED_AVAILABILITY;
+extern const char* MQTT_TOPIC_PRESSURE_SHED_AVAILABILITY;
+extern const char* MQTT_TOPIC_LUX_SHED_AVAILABILITY;
+
+// --- Diagnostics ---
+extern const char* MQTT_TOPIC_I2C_HEALTH_STATE;
+extern const char* MQTT_TOPIC_I2C_HEALTH_ATTRIBUTES;
+extern const char* MQTT_TOPIC_CLIMATE_SAMPLE_INTERVAL_STATE;
+extern const char* MQTT_TOPIC_PRESSURE_SAMPLE_INTERVAL_STATE;
+extern const char* MQTT_TOPIC_LUX_SAMPLE_INTERVAL_STATE;
+extern const char* MQTT_TOPIC_BOOT_TIME_STATE;
+extern const char* MQTT_TOPIC_BOOT_TIME_ATTRIBUTES;
+extern const char* MQTT_TOPIC_MQTT_LOAD_STATE;
+extern const char* MQTT_TOPIC_MQTT_LOAD_ATTRIBUTES;
+
 // --- MQTT Payloads ---
 extern const char* MQTT_PAYLOAD_ONLINE;
 extern const char* MQTT_PAYLOAD_OFFLINE;
@@ -8,8 +8,10 @@
 extern PubSubClient client;
 
 // This is the public list of functions available from this module.
-void setup_wifi();
+void setup_wifi();   // Non-blocking, call loop_wifi() from loop()
+void loop_wifi();
 void reconnect();
+void loop_mqtt_deferred(); // Discovery and boot metrics, after state has gone out
 void mqtt_callback(char* topic, byte* payload, unsigned int length);
 
 #endif // CONNECTIONS_H
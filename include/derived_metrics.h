@@ -0,0 +1,13 @@
+#ifndef DERIVED_METRICS_H
+#define DERIVED_METRICS_H
+
+// --- Public Interface for the Derived-Metric Stage ---
+
+// Call these from read_environmental_sensors() with each validated reading
+void record_climate_reading(float temperatureC, float humidity);
+void record_pressure_reading(float pressure_hPa);
+
+// Call this from loop()
+void loop_derived_metrics();
+
+#endif // DERIVED_METRICS_H
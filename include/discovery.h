@@ -1,7 +1,15 @@
 #ifndef DISCOVERY_H
 #define DISCOVERY_H
 
-// The public function that will be called from connections.cpp
-void mqtt_discovery();
+#include <Arduino.h>
+
+// The public function that will be called from connections.cpp.
+// Publishes only if the document changed since the broker last confirmed it
+// (or force is set). Returns false if the publish failed and should be retried.
+bool mqtt_discovery(bool force);
+
+// Feed messages on MQTT_TOPIC_DEVICE_DISCOVERY here. The hash is saved only
+// when the retained document read back from the broker matches what was sent.
+void handle_discovery_echo(const byte* payload, unsigned int length);
 
 #endif // DISCOVERY_H //
\ No newline at end of file
@@ -22,5 +22,7 @@ void handle_manual_timer_command(String message);
 // unsigned long get_motion_timer_duration();
 // unsigned long get_manual_timer_duration();
 unsigned long get_current_timer_duration();
+bool is_occupied(); // PIR active or light on
+unsigned long get_first_relay_action_ms(); // Boot timing, 0 until the relay has switched
 
 #endif // LIGHT_CONTROLLER_H
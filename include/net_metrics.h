@@ -0,0 +1,20 @@
+#ifndef NET_METRICS_H
+#define NET_METRICS_H
+
+// --- MQTT Load Metrics ---
+// Measured on the device so a soak run against any broker can read them back
+// over MQTT: command throughput, on-device command handling latency and heap
+// low-water. End-to-end latency needs the sender's clock; see MQTT_TOPIC_LIGHT_ACK.
+
+// Call from mqtt_callback() for every message, and again if it was dropped
+void record_mqtt_message();
+void record_mqtt_message_rejected();
+
+// Call when the relay switches in response to a light command, with the time
+// since the command reached handle_light_command() (excludes broker and network)
+void record_command_latency(unsigned long latencyUs);
+
+// Call this from loop()
+void loop_net_metrics();
+
+#endif // NET_METRICS_H
@@ -0,0 +1,39 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <Arduino.h>
+
+// --- Adaptively Scheduled Sensor Channels ---
+enum SampleChannel {
+  SAMPLE_CLIMATE = 0, // AHT10 temperature + humidity
+  SAMPLE_PRESSURE,    // BMP280
+  SAMPLE_LUX,         // VEML7700, also sped up while the shed is occupied
+  SAMPLE_CHANNEL_COUNT
+};
+
+// Signals within a channel; the more volatile one drives the channel's rate
+enum SampleSignal {
+  SIGNAL_PRIMARY = 0,
+  SIGNAL_SECONDARY,
+  SAMPLE_SIGNAL_COUNT
+};
+
+// Interval bounds accepted over MQTT; SAMPLE_BOUND_MAX_SEC is the longest a
+// channel can go between readings
+const unsigned long SAMPLE_BOUND_MIN_SEC = 1;
+const unsigned long SAMPLE_BOUND_MAX_SEC = 3600;
+
+// Returns true (and restarts the channel's timer) when the channel should be read now
+bool sample_due(SampleChannel channel);
+
+// Feed each new reading back so the scheduler can adapt the channel's interval
+void sample_record(SampleChannel channel, float value, SampleSignal signal = SIGNAL_PRIMARY);
+
+// --- MQTT Command Handler ---
+// Handles the per-channel min/max bound commands; returns false if the topic isn't one of ours
+bool handle_sampling_command(const String& topic, String message);
+
+// Publishes bounds and effective intervals (call on MQTT reconnect)
+void publish_sampling_state();
+
+#endif // SAMPLING_H
@@ -0,0 +1,40 @@
+#ifndef SENSOR_HEALTH_H
+#define SENSOR_HEALTH_H
+
+// --- I2C Devices Watched by the Sensor Supervisor ---
+enum SensorDevice {
+  SENSOR_AHT10 = 0,
+  SENSOR_BMP280,
+  SENSOR_VEML7700,
+  SENSOR_DEVICE_COUNT
+};
+
+// Call this from setup_environmental_sensors() before probing the drivers
+void setup_sensor_health();
+
+// Call this from loop()
+void loop_sensor_health();
+
+// --- Read Gate ---
+// Returns false if the device is offline or does not ACK its address; the
+// caller must then skip the read. On true, finish with sensor_end_read() so
+// latency is tracked (it may be called on a later loop pass for split reads).
+bool sensor_begin_read(SensorDevice device);
+void sensor_end_read(SensorDevice device, bool valid);
+
+// Split reads pause the latency clock while waiting between Wire transactions
+// (e.g. a conversion), so only time spent on the bus is measured
+void sensor_pause_read(SensorDevice device);
+void sensor_resume_read(SensorDevice device);
+
+// --- Re-probe With Backoff ---
+// True once an offline device's backoff has elapsed and it should be re-probed
+bool sensor_probe_due(SensorDevice device);
+void sensor_record_probe(SensorDevice device, bool found);
+
+bool sensor_is_online(SensorDevice device);
+
+// Publishes the retained per-entity availability (call on MQTT reconnect)
+void publish_sensor_availability();
+
+#endif // SENSOR_HEALTH_H
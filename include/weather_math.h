@@ -0,0 +1,172 @@
+#ifndef WEATHER_MATH_H
+#define WEATHER_MATH_H
+
+// Pure math for the derived-metric stage. Deliberately free of Arduino
+// headers so it can be compiled and checked on the host.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <math.h>
+
+// --- Psychrometrics ---
+// Dew point (°C) from temperature (°C) and relative humidity (%), Magnus
+// formula with Sonntag (1990) constants; within ±0.35 °C for -45..60 °C.
+float dew_point_c(float temperatureC, float humidity);
+
+// NWS heat index (°F) from temperature (°F) and relative humidity (%):
+// Steadman's simple form below 80 °F, Rothfusz regression with the NWS
+// low/high humidity adjustments above.
+float heat_index_f(float temperatureF, float humidity);
+
+// --- Rolling Window ---
+// Fixed-memory sliding window over time buckets of bucketMs each, covering
+// BUCKETS * bucketMs. add() is O(1) (amortised over skipped buckets), mean()
+// is O(1) from running totals, minimum()/maximum() scan the fixed bucket array.
+//
+// mean() is time-weighted (trapezoidal), so adaptive sampling that speeds up
+// during fast changes doesn't bias it. Each step between consecutive samples
+// is credited to the later sample's bucket; steps longer than maxStepMs are
+// treated as an outage (sensor offline) and not interpolated across.
+template <size_t BUCKETS>
+class RollingWindow {
+public:
+  explicit RollingWindow(unsigned long bucketMs, unsigned long maxStepMs = 0)
+      : bucketMs(bucketMs), maxStepMs(maxStepMs > 0 ? maxStepMs : bucketMs) {}
+
+  void add(unsigned long now, float value) {
+    bool first = !started;
+    if (first) {
+      started = true;
+      bucketStart = now;
+      filled = 1;
+    }
+    advance(now);
+
+    Bucket& b = buckets[head];
+    if (b.count == 0 || value < b.min) b.min = value;
+    if (b.count == 0 || value > b.max) b.max = value;
+    b.sum += value;
+    b.count++;
+    totalSum += value;
+    totalCount++;
+
+    unsigned long dt = now - lastTime;
+    if (!first && dt <= maxStepMs) {
+      double area = (lastValue + (double)value) / 2.0 * dt;
+      b.area += area;
+      b.duration += dt;
+      totalArea += area;
+      totalDuration += dt;
+    }
+    lastTime = now;
+    lastValue = value;
+  }
+
+  bool empty() const { return totalCount == 0; }
+
+  float minimum() const {
+    float result = NAN;
+    for (const Bucket& b : buckets) {
+      if (b.count > 0 && (isnan(result) || b.min < result)) result = b.min;
+    }
+    return result;
+  }
+
+  float maximum() const {
+    float result = NAN;
+    for (const Bucket& b : buckets) {
+      if (b.count > 0 && (isnan(result) || b.max > result)) result = b.max;
+    }
+    return result;
+  }
+
+  // Time-weighted mean; falls back to the plain mean while the window holds a single instant
+  float mean() const {
+    if (totalDuration > 0.0) return (float)(totalArea / totalDuration);
+    return totalCount > 0 ? (float)(totalSum / totalCount) : NAN;
+  }
+
+  // Mean of the bucket `ago` buckets before the current one (0 = current), NAN if empty
+  float bucket_mean(size_t ago) const {
+    if (ago >= filled) return NAN;
+    const Bucket& b = bucket_at(ago);
+    return b.count > 0 ? (float)(b.sum / b.count) : NAN;
+  }
+
+  // Number of buckets the window has spanned so far (saturates at BUCKETS)
+  size_t span() const { return filled; }
+
+  // Change from the oldest to the newest non-empty bucket mean, scaled to the
+  // full BUCKETS - 1 bucket span so sparse sampling doesn't leave holes.
+  // NAN until the window is full, or if the non-empty buckets cover less
+  // than half of it.
+  float change_over_window() const {
+    if (filled < BUCKETS) return NAN;
+    size_t newest = 0;
+    while (newest < BUCKETS && bucket_at(newest).count == 0) newest++;
+    size_t oldest = BUCKETS - 1;
+    while (oldest > newest && bucket_at(oldest).count == 0) oldest--;
+    if (newest >= BUCKETS || oldest - newest < (BUCKETS - 1) / 2) return NAN;
+    return (bucket_mean(newest) - bucket_mean(oldest)) * (float)(BUCKETS - 1) / (float)(oldest - newest);
+  }
+
+private:
+  struct Bucket {
+    float min;
+    float max;
+    double sum;
+    uint32_t count;
+    double area;       // Integral of value over time, value * ms
+    double duration;   // ms covered by area
+  };
+
+  const Bucket& bucket_at(size_t ago) const {
+    return buckets[(head + BUCKETS - ago) % BUCKETS];
+  }
+
+  void advance(unsigned long now) {
+    size_t steps = 0;
+    while (now - bucketStart >= bucketMs) {
+      bucketStart += bucketMs;
+      if (steps < BUCKETS) {
+        head = (head + 1) % BUCKETS;
+        evict(buckets[head]);
+        if (filled < BUCKETS) filled++;
+        steps++;
+      } else {
+        // Everything is already evicted; jump straight to the current bucket
+        bucketStart += ((now - bucketStart) / bucketMs) * bucketMs;
+      }
+    }
+  }
+
+  void evict(Bucket& b) {
+    totalSum -= b.sum;
+    totalCount -= b.count;
+    totalArea -= b.area;
+    totalDuration -= b.duration;
+    b = Bucket();
+    if (totalCount == 0) {
+      // Drop accumulated rounding error
+      totalSum = 0.0;
+      totalArea = 0.0;
+      totalDuration = 0.0;
+    }
+  }
+
+  const unsigned long bucketMs;
+  const unsigned long maxStepMs;
+  Bucket buckets[BUCKETS] = {};
+  size_t head = 0;
+  size_t filled = 0;
+  unsigned long bucketStart = 0;
+  bool started = false;
+  double totalSum = 0.0;
+  uint32_t totalCount = 0;
+  double totalArea = 0.0;
+  double totalDuration = 0.0;
+  unsigned long lastTime = 0;
+  float lastValue = 0.0;
+};
+
+#endif // WEATHER_MATH_H
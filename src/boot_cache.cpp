@@ -0,0 +1,84 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include <string.h>
+#include "boot_cache.h"
+
+// --- NVS Layout ---
+const char* BOOT_CACHE_NAMESPACE = "fastboot";
+const char* KEY_WIFI_CACHE = "wifi";
+const char* KEY_DISCOVERY_HASH = "disc_hash";
+
+// Bump when WifiCache changes shape so stale blobs are ignored
+const uint32_t WIFI_CACHE_VERSION = 1;
+
+struct StoredWifiCache {
+  uint32_t version;
+  WifiCache cache;
+};
+
+Preferences bootPrefs;
+
+bool same_wifi_cache(const WifiCache& a, const WifiCache& b) {
+  return a.channel == b.channel && memcmp(a.bssid, b.bssid, sizeof(a.bssid)) == 0 &&
+         a.ip == b.ip && a.gateway == b.gateway && a.subnet == b.subnet && a.dns == b.dns;
+}
+
+bool load_wifi_cache(WifiCache& cache) {
+  StoredWifiCache stored;
+  bootPrefs.begin(BOOT_CACHE_NAMESPACE, true);
+  size_t length = bootPrefs.getBytes(KEY_WIFI_CACHE, &stored, sizeof(stored));
+  bootPrefs.end();
+
+  if (length != sizeof(stored) || stored.version != WIFI_CACHE_VERSION || stored.cache.channel <= 0) {
+    return false;
+  }
+  cache = stored.cache;
+  return true;
+}
+
+void save_wifi_cache(const WifiCache& cache) {
+  WifiCache current;
+  if (load_wifi_cache(current) && same_wifi_cache(current, cache)) {
+    return;
+  }
+
+  StoredWifiCache stored;
+  memset(&stored, 0, sizeof(stored));
+  stored.version = WIFI_CACHE_VERSION;
+  stored.cache = cache;
+  bootPrefs.begin(BOOT_CACHE_NAMESPACE, false);
+  bootPrefs.putBytes(KEY_WIFI_CACHE, &stored, sizeof(stored));
+  bootPrefs.end();
+  Serial.println("Saved Wi-Fi fast-boot cache.");
+}
+
+void clear_wifi_cache() {
+  bootPrefs.begin(BOOT_CACHE_NAMESPACE, false);
+  bootPrefs.remove(KEY_WIFI_CACHE);
+  bootPrefs.end();
+}
+
+uint32_t load_discovery_hash() {
+  bootPrefs.begin(BOOT_CACHE_NAMESPACE, true);
+  uint32_t hash = bootPrefs.getUInt(KEY_DISCOVERY_HASH, 0);
+  bootPrefs.end();
+  return hash;
+}
+
+void save_discovery_hash(uint32_t hash) {
+  if (load_discovery_hash() == hash) {
+    return;
+  }
+  bootPrefs.begin(BOOT_CACHE_NAMESPACE, false);
+  bootPrefs.putUInt(KEY_DISCOVERY_HASH, hash);
+  bootPrefs.end();
+}
+
+uint32_t fnv1a_hash(const char* data, size_t length) {
+  uint32_t hash = 2166136261UL;
+  for (size_t i = 0; i < length; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= 16777619UL;
+  }
+  return hash;
+}
@@ -17,6 +17,15 @@ const int LED_PIN = LED_BUILTIN; // On-board LED for PIR indication
 const char* WIFI_SSID = "M&M Motors";
 const char* WIFI_PASSWORD = "seamosss";
 
+// --- Fast Boot / Network ---
+const bool USE_STATIC_IP = false;
+const char* STATIC_IP = "192.168.0.71";
+const char* STATIC_GATEWAY = "192.168.0.1";
+const char* STATIC_SUBNET = "255.255.255.0";
+const char* STATIC_DNS = "192.168.0.1";
+const bool FAST_BOOT_REUSE_LEASE = false;
+const unsigned long FAST_CONNECT_TIMEOUT_MS = 5000; // Fall back to a full scan + DHCP after this
+
 // --- MQTT Broker Settings ---
 const char* MQTT_SERVER = "192.168.0.70";
 const char* MQTT_USER = "mqtt_user";
@@ -30,11 +39,14 @@ unsigned long INITIAL_MANUAL_TIMER_DURATION_MS = 300000; // 5 minutes
 
 // --- Device Availability ---
 const char* MQTT_TOPIC_DEVICE_AVAILABILITY = "devices/shed_sensor_hub/status";
+const char* MQTT_TOPIC_HA_STATUS = "homeassistant/status";
+const char* MQTT_TOPIC_DEVICE_DISCOVERY = "homeassistant/device/shed_sensor_hub/config";
 
 // --- Light Control ---
 const char* MQTT_BASE_TOPIC_LIGHT = "home/shed/light/main";
 const char* MQTT_TOPIC_LIGHT_STATE = "home/shed/light/main/state";
 const char* MQTT_TOPIC_LIGHT_COMMAND = "home/shed/light/main/command";
+const char* MQTT_TOPIC_LIGHT_ACK = "home/shed/light/main/ack";
 
 // --- Timers ---
 const char* MQTT_BASE_TOPIC_MOTION_TIMER = "home/shed/number/motion_timer";
@@ -46,6 +58,28 @@ const char* MQTT_BASE_TOPIC_MANUAL_TIMER = "home/shed/number/manual_timer";
 const char* MQTT_TOPIC_MANUAL_TIMER_STATE = "home/shed/number/manual_timer/state";
 const char* MQTT_TOPIC_MANUAL_TIMER_COMMAND = "home/shed/number/manual_timer/command";
 
+// --- Adaptive Sampling Bounds ---
+const char* MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MIN = "home/shed/number/climate_sample_min";
+const char* MQTT_TOPIC_CLIMATE_SAMPLE_MIN_STATE = "home/shed/number/climate_sample_min/state";
+const char* MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND = "home/shed/number/climate_sample_min/command";
+const char* MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MAX = "home/shed/number/climate_sample_max";
+const char* MQTT_TOPIC_CLIMATE_SAMPLE_MAX_STATE = "home/shed/number/climate_sample_max/state";
+const char* MQTT_TOPIC_CLIMATE_SAMPLE_MAX_COMMAND = "home/shed/number/climate_sample_max/command";
+
+const char* MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MIN = "home/shed/number/pressure_sample_min";
+const char* MQTT_TOPIC_PRESSURE_SAMPLE_MIN_STATE = "home/shed/number/pressure_sample_min/state";
+const char* MQTT_TOPIC_PRESSURE_SAMPLE_MIN_COMMAND = "home/shed/number/pressure_sample_min/command";
+const char* MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MAX = "home/shed/number/pressure_sample_max";
+const char* MQTT_TOPIC_PRESSURE_SAMPLE_MAX_STATE = "home/shed/number/pressure_sample_max/state";
+const char* MQTT_TOPIC_PRESSURE_SAMPLE_MAX_COMMAND = "home/shed/number/pressure_sample_max/command";
+
+const char* MQTT_BASE_TOPIC_LUX_SAMPLE_MIN = "home/shed/number/lux_sample_min";
+const char* MQTT_TOPIC_LUX_SAMPLE_MIN_STATE = "home/shed/number/lux_sample_min/state";
+const char* MQTT_TOPIC_LUX_SAMPLE_MIN_COMMAND = "home/shed/number/lux_sample_min/command";
+const char* MQTT_BASE_TOPIC_LUX_SAMPLE_MAX = "home/shed/number/lux_sample_max";
+const char* MQTT_TOPIC_LUX_SAMPLE_MAX_STATE = "home/shed/number/lux_sample_max/state";
+const char* MQTT_TOPIC_LUX_SAMPLE_MAX_COMMAND = "home/shed/number/lux_sample_max/command";
+
 // --- Sensors ---
 const char* MQTT_TOPIC_MOTION_STATE = "home/shed/binary_sensor/motion/state";
 const char* MQTT_TOPIC_OCCUPANCY_STATE = "home/shed/binary_sensor/occupancy/state";
@@ -54,6 +88,31 @@ const char* MQTT_TOPIC_HUMIDITY_SHED_STATE = "home/shed/sensor/humidity/state";
 const char* MQTT_TOPIC_PRESSURE_SHED_STATE = "home/shed/sensor/pressure/state";
 const char* MQTT_TOPIC_LUX_SHED_STATE = "home/shed/sensor/lux/state";
 
+// --- Derived Metrics ---
+const char* MQTT_TOPIC_DEW_POINT_SHED_STATE = "home/shed/sensor/dew_point/state";
+const char* MQTT_TOPIC_HEAT_INDEX_SHED_STATE = "home/shed/sensor/heat_index/state";
+const char* MQTT_TOPIC_PRESSURE_TENDENCY_SHED_STATE = "home/shed/sensor/pressure_tendency/state";
+const char* MQTT_TOPIC_TEMPERATURE_24H_MIN_SHED_STATE = "home/shed/sensor/temperature_24h_min/state";
+const char* MQTT_TOPIC_TEMPERATURE_24H_MAX_SHED_STATE = "home/shed/sensor/temperature_24h_max/state";
+const char* MQTT_TOPIC_TEMPERATURE_24H_MEAN_SHED_STATE = "home/shed/sensor/temperature_24h_mean/state";
+
+// --- Sensor Availability (per entity) ---
+const char* MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY = "home/shed/sensor/temperature/availability";
+const char* MQTT_TOPIC_HUMIDITY_SHED_AVAILABILITY = "home/shed/sensor/humidity/availability";
+const char* MQTT_TOPIC_PRESSURE_SHED_AVAILABILITY = "home/shed/sensor/pressure/availability";
+const char* MQTT_TOPIC_LUX_SHED_AVAILABILITY = "home/shed/sensor/lux/availability";
+
+// --- Diagnostics ---
+const char* MQTT_TOPIC_I2C_HEALTH_STATE = "home/shed/sensor/i2c_health/state";
+const char* MQTT_TOPIC_I2C_HEALTH_ATTRIBUTES = "home/shed/sensor/i2c_health/attributes";
+const char* MQTT_TOPIC_CLIMATE_SAMPLE_INTERVAL_STATE = "home/shed/sensor/climate_sample_interval/state";
+const char* MQTT_TOPIC_PRESSURE_SAMPLE_INTERVAL_STATE = "home/shed/sensor/pressure_sample_interval/state";
+const char* MQTT_TOPIC_LUX_SAMPLE_INTERVAL_STATE = "home/shed/sensor/lux_sample_interval/state";
+const char* MQTT_TOPIC_BOOT_TIME_STATE = "home/shed/sensor/boot_time/state";
+const char* MQTT_TOPIC_BOOT_TIME_ATTRIBUTES = "home/shed/sensor/boot_time/attributes";
+const char* MQTT_TOPIC_MQTT_LOAD_STATE = "home/shed/sensor/mqtt_load/state";
+const char* MQTT_TOPIC_MQTT_LOAD_ATTRIBUTES = "home/shed/sensor/mqtt_load/attributes";
+
 // --- MQTT Payloads ---
 const char* MQTT_PAYLOAD_ONLINE = "online";
 const char* MQTT_PAYLOAD_OFFLINE = "offline";
@@ -1,46 +1,148 @@
 #include <WiFi.h>
+#include <string.h>
 #include <PubSubClient.h>
+#include <ArduinoJson.h>
 #include "connections.h"
 #include "config.h"
 #include "discovery.h"      // For MQTT discovery message
 #include "light_controller.h" // To handle light commands and timer updates
+#include "sensor_health.h"  // For per-sensor availability
+#include "sampling.h"       // For sample rate bounds
+#include "boot_cache.h"     // For the Wi-Fi fast-boot cache
+#include "net_metrics.h"    // For message counters
 
 // This requires the global client object defined in main.cpp
 extern PubSubClient client;
 
+// --- Fast Boot State ---
+bool fastConnectAttempt = false;   // Currently trying the cached channel/BSSID
+bool usedFastConnect = false;      // This boot's connection came up via the cache
+bool wifiWasConnected = false;
+unsigned long wifiBeginTime = 0;
+unsigned long wifiConnectedTime = 0; // millis() when Wi-Fi first came up, 0 until then
+unsigned long mqttOnlineTime = 0;    // millis() when MQTT first came up, 0 until then
+
+// --- Deferred Publishing ---
+bool discoveryPending = false;
+bool discoveryForced = false;
+bool bootMetricsPending = false;
+unsigned long publishedFirstRelayTime = 0;
+
+// Starts the connection and returns immediately; loop_wifi() finishes the job
+// so the light controller runs while the network comes up.
 void setup_wifi() {
-  delay(10);
   Serial.println();
   Serial.print("Connecting to ");
   Serial.println(WIFI_SSID);
 
   WiFi.setHostname(DEVICE_ID);
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  WiFi.persistent(false); // We keep our own cache; don't rewrite the SDK config in flash every boot
+  WiFi.mode(WIFI_STA);
+
+  WifiCache cache;
+  bool haveCache = load_wifi_cache(cache);
+
+  if (USE_STATIC_IP) {
+    IPAddress ip, gateway, subnet, dns;
+    ip.fromString(STATIC_IP);
+    gateway.fromString(STATIC_GATEWAY);
+    subnet.fromString(STATIC_SUBNET);
+    dns.fromString(STATIC_DNS);
+    WiFi.config(ip, gateway, subnet, dns);
+  } else if (FAST_BOOT_REUSE_LEASE && haveCache && cache.ip != 0) {
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+  }
 
-  while (WiFi.status() != WL_CONNECTED) {
-    delay(500);
-    Serial.print(".");
+  if (haveCache) {
+    // Skip the scan: go straight to the AP we used last time
+    Serial.print("Fast connect on channel ");
+    Serial.println(cache.channel);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cache.channel, cache.bssid);
+    fastConnectAttempt = true;
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
   }
+  wifiBeginTime = millis();
+}
+
+void loop_wifi() {
+  bool connected = (WiFi.status() == WL_CONNECTED);
 
-  Serial.println("");
-  Serial.println("WiFi connected");
-  Serial.print("IP address: ");
-  Serial.println(WiFi.localIP());
+  if (connected && !wifiWasConnected) {
+    wifiWasConnected = true;
+    if (wifiConnectedTime == 0) {
+      wifiConnectedTime = millis();
+      usedFastConnect = fastConnectAttempt;
+    }
+    fastConnectAttempt = false;
+
+    Serial.println("WiFi connected");
+    Serial.print("IP address: ");
+    Serial.println(WiFi.localIP());
+
+    WifiCache cache;
+    cache.channel = WiFi.channel();
+    memcpy(cache.bssid, WiFi.BSSID(), sizeof(cache.bssid));
+    cache.ip = WiFi.localIP();
+    cache.gateway = WiFi.gatewayIP();
+    cache.subnet = WiFi.subnetMask();
+    cache.dns = WiFi.dnsIP();
+    save_wifi_cache(cache);
+
+  } else if (!connected) {
+    wifiWasConnected = false;
+
+    // The AP moved channel, was replaced, or the cached lease is no good
+    if (fastConnectAttempt && millis() - wifiBeginTime > FAST_CONNECT_TIMEOUT_MS) {
+      Serial.println("Fast connect failed, falling back to full scan and DHCP.");
+      fastConnectAttempt = false;
+      clear_wifi_cache();
+      WiFi.disconnect();
+      if (!USE_STATIC_IP) {
+        WiFi.config(IPAddress((uint32_t)0), IPAddress((uint32_t)0), IPAddress((uint32_t)0)); // Back to DHCP
+      }
+      WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+      wifiBeginTime = millis();
+    }
+  }
 }
 
 // --- MQTT Message Callback ---
 // This function is the central router for all incoming MQTT messages.
 void mqtt_callback(char* topic, byte* payload, unsigned int length) {
+  record_mqtt_message();
+
+  // Our own retained discovery document read back for confirmation; the only
+  // message that is legitimately larger than a command
+  if (strcmp(topic, MQTT_TOPIC_DEVICE_DISCOVERY) == 0) {
+    handle_discovery_echo(payload, length);
+    return;
+  }
+
+  // Every command payload is a short token or number; anything longer is junk.
+  // Dropping it here also avoids writing a terminator past the end of a full
+  // PubSubClient buffer.
+  if (length > MQTT_MAX_COMMAND_PAYLOAD) {
+    record_mqtt_message_rejected();
+    Serial.print("Dropped oversized MQTT payload on ");
+    Serial.print(topic);
+    Serial.print(" (");
+    Serial.print(length);
+    Serial.println(" bytes)");
+    return;
+  }
+
   // Convert the payload to a printable string
-  payload[length] = '\0'; // Add a null terminator
-  String message = (char*)payload;
+  char buffer[MQTT_MAX_COMMAND_PAYLOAD + 1];
+  memcpy(buffer, payload, length);
+  buffer[length] = '\0'; // Add a null terminator
+  String message = buffer;
 
-  Serial.println("--- MQTT Message Received ---");
-  Serial.print("Topic: ");
-  Serial.println(topic);
-  Serial.print("Payload: ");
+  // One line per message so a command flood doesn't stall on Serial
+  Serial.print("MQTT message: ");
+  Serial.print(topic);
+  Serial.print(" = ");
   Serial.println(message);
-  Serial.println("-----------------------------");
 
   // ---- Route messages to the light controller based on topic ----
   if (String(topic) == MQTT_TOPIC_LIGHT_COMMAND) {
@@ -49,6 +151,14 @@ void mqtt_callback(char* topic, byte* payload, unsigned int length) {
     handle_motion_timer_command(message);
   } else if (String(topic) == MQTT_TOPIC_MANUAL_TIMER_COMMAND) {
     handle_manual_timer_command(message);
+  } else if (String(topic) == MQTT_TOPIC_HA_STATUS) {
+    // Home Assistant restarted and lost its entities: resend discovery even if unchanged
+    if (message == MQTT_PAYLOAD_ONLINE) {
+      discoveryPending = true;
+      discoveryForced = true;
+    }
+  } else {
+    handle_sampling_command(String(topic), message);
   }
 }
 
@@ -61,6 +171,7 @@ void reconnect() {
     
     // Publish device availability
     client.publish(MQTT_TOPIC_DEVICE_AVAILABILITY, MQTT_PAYLOAD_ONLINE, true);
+    publish_sensor_availability();
     
     // Publish the initial timer states (in seconds)
     String motion_payload = String(INITIAL_MOTION_TIMER_DURATION_MS / 1000);
@@ -70,16 +181,33 @@ void reconnect() {
     client.publish(MQTT_TOPIC_MANUAL_TIMER_STATE, manual_payload.c_str(), true);
 
     Serial.println("Published initial timer states.");
+
+    publish_sampling_state();
     
     // --- Subscribe to Command Topics ---
     Serial.println("------------------------------");
     client.subscribe(MQTT_TOPIC_LIGHT_COMMAND);
     client.subscribe(MQTT_TOPIC_MOTION_TIMER_COMMAND);
     client.subscribe(MQTT_TOPIC_MANUAL_TIMER_COMMAND);
+    client.subscribe(MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND);
+    client.subscribe(MQTT_TOPIC_CLIMATE_SAMPLE_MAX_COMMAND);
+    client.subscribe(MQTT_TOPIC_PRESSURE_SAMPLE_MIN_COMMAND);
+    client.subscribe(MQTT_TOPIC_PRESSURE_SAMPLE_MAX_COMMAND);
+    client.subscribe(MQTT_TOPIC_LUX_SAMPLE_MIN_COMMAND);
+    client.subscribe(MQTT_TOPIC_LUX_SAMPLE_MAX_COMMAND);
+    client.subscribe(MQTT_TOPIC_HA_STATUS);
     Serial.println("Subscribed to command topics.");
 
-    // Publish the discovery message
-    mqtt_discovery();
+    // State goes out first; discovery follows from loop_mqtt_deferred()
+    discoveryPending = true;
+
+    if (mqttOnlineTime == 0) {
+      mqttOnlineTime = millis();
+      bootMetricsPending = true;
+      Serial.print("Time to online: ");
+      Serial.print(mqttOnlineTime);
+      Serial.println(" ms");
+    }
 
   } else {
     Serial.print("failed, rc=");
@@ -87,3 +215,37 @@ void reconnect() {
     Serial.println(" try again in 5 seconds");
   }
 }
+
+// --- Boot Timing ---
+void publish_boot_metrics() {
+  unsigned long firstRelayTime = get_first_relay_action_ms();
+
+  JsonDocument attributes;
+  attributes["wifi_ms"] = wifiConnectedTime;
+  attributes["mqtt_ms"] = mqttOnlineTime;
+  if (firstRelayTime != 0) {
+    attributes["first_relay_ms"] = firstRelayTime;
+  }
+  attributes["fast_connect"] = usedFastConnect;
+
+  char buffer[128];
+  serializeJson(attributes, buffer);
+  client.publish(MQTT_TOPIC_BOOT_TIME_ATTRIBUTES, buffer, true);
+  if (client.publish(MQTT_TOPIC_BOOT_TIME_STATE, String(mqttOnlineTime).c_str(), true)) {
+    bootMetricsPending = false;
+    publishedFirstRelayTime = firstRelayTime;
+  }
+}
+
+// --- Deferred Publishing ---
+// Call this from loop() while MQTT is connected
+void loop_mqtt_deferred() {
+  if (discoveryPending && mqtt_discovery(discoveryForced)) {
+    discoveryPending = false;
+    discoveryForced = false;
+  }
+
+  if (bootMetricsPending || get_first_relay_action_ms() != publishedFirstRelayTime) {
+    publish_boot_metrics();
+  }
+}
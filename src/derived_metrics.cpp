@@ -0,0 +1,63 @@
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include "derived_metrics.h"
+#include "weather_math.h"
+#include "sampling.h"
+#include "config.h"
+
+extern PubSubClient client;
+
+// --- Rolling Windows (fixed memory, see weather_math.h) ---
+// 24 h of temperature in 30 minute buckets. Gaps up to twice the longest
+// sample interval are interpolated (a channel set to the maximum still lands
+// a little late, after the read itself and loop jitter); longer ones are
+// sensor outages.
+RollingWindow<48> temperatureDaily(30UL * 60 * 1000, 2 * SAMPLE_BOUND_MAX_SEC * 1000);
+// 3 h of pressure in 15 minute buckets; 13 so the oldest bucket is a full 3 h back
+RollingWindow<13> pressureTrend(15UL * 60 * 1000);
+
+// --- Non-Blocking Timers ---
+unsigned long lastStatsPublishTime = 0;
+const unsigned long STATS_PUBLISH_INTERVAL = 60000; // Publish window statistics every minute
+
+// --- Private Helper Functions ---
+float c_to_f(float celsius) {
+  return (celsius * 9.0 / 5.0) + 32.0;
+}
+
+void publish_metric(const char* topic, float value) {
+  if (!isnan(value)) {
+    client.publish(topic, String(value).c_str(), true);
+  }
+}
+
+// --- Sample Intake ---
+void record_climate_reading(float temperatureC, float humidity) {
+  float temperatureF = c_to_f(temperatureC);
+  temperatureDaily.add(millis(), temperatureF);
+
+  publish_metric(MQTT_TOPIC_DEW_POINT_SHED_STATE, c_to_f(dew_point_c(temperatureC, humidity)));
+  publish_metric(MQTT_TOPIC_HEAT_INDEX_SHED_STATE, heat_index_f(temperatureF, humidity));
+}
+
+void record_pressure_reading(float pressure_hPa) {
+  pressureTrend.add(millis(), pressure_hPa);
+}
+
+// --- Main Loop Function ---
+void loop_derived_metrics() {
+  if (millis() - lastStatsPublishTime < STATS_PUBLISH_INTERVAL) {
+    return;
+  }
+  lastStatsPublishTime = millis();
+
+  if (!temperatureDaily.empty()) {
+    publish_metric(MQTT_TOPIC_TEMPERATURE_24H_MIN_SHED_STATE, temperatureDaily.minimum());
+    publish_metric(MQTT_TOPIC_TEMPERATURE_24H_MAX_SHED_STATE, temperatureDaily.maximum());
+    publish_metric(MQTT_TOPIC_TEMPERATURE_24H_MEAN_SHED_STATE, temperatureDaily.mean());
+  }
+
+  // NAN (not published) until the window reaches 3 h back; sample gaps from a
+  // long pressure interval are bridged by the nearest non-empty buckets
+  publish_metric(MQTT_TOPIC_PRESSURE_TENDENCY_SHED_STATE, pressureTrend.change_over_window());
+}
@@ -2,15 +2,80 @@
 #include <PubSubClient.h>
 #include "discovery.h"
 #include "config.h"
+#include "boot_cache.h"
 
 // This function needs access to the global MQTT client object
 extern PubSubClient client;
 
-void mqtt_discovery() {
+// --- Round-Trip Confirmation ---
+// publish() is QoS 0, so true only means the bytes reached the socket. The
+// hash is stored once the broker hands the retained document back to us.
+bool discoveryConfirmPending = false;
+uint32_t pendingDiscoveryHash = 0;
+
+// Sensor entities go unavailable when either the hub or their own I2C device is offline
+void add_sensor_availability(JsonObject cmp, const char* sensor_availability_topic) {
+    JsonArray avty = cmp["avty"].to<JsonArray>();
+    avty.add<JsonObject>()["t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;   // devices/shed_sensor_hub/status
+    avty.add<JsonObject>()["t"] = sensor_availability_topic;        // home/shed/sensor/<name>/availability
+    cmp["avty_mode"] = "all";
+}
+
+// Number entity bounding one adaptive sampling channel (seconds)
+void add_sample_bound_number(JsonObject cmps, const char* key, const char* name, const char* base_topic) {
+    JsonObject cmp = cmps[String("shed_") + key].to<JsonObject>();
+    cmp["name"] = name;
+    cmp["p"] = "number";
+    cmp["ent_cat"] = "config";
+    cmp["min"] = 1;
+    cmp["max"] = 3600;
+    cmp["unit_of_meas"] = "s";
+    cmp["uniq_id"] = String("shed_sensor_hub_") + key;
+    cmp["object_id"] = String("shed_") + key;
+    cmp["~"] = base_topic;                                   // home/shed/number/<key>
+    cmp["stat_t"] = "~/state";                               // home/shed/number/<key>/state
+    cmp["cmd_t"] = "~/command";                              // home/shed/number/<key>/command
+    cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;          // devices/shed_sensor_hub/status
+}
+
+// Diagnostic sensor reporting a channel's current effective sample interval
+void add_sample_interval_sensor(JsonObject cmps, const char* key, const char* name, const char* state_topic) {
+    JsonObject cmp = cmps[String("shed_") + key].to<JsonObject>();
+    cmp["name"] = name;
+    cmp["p"] = "sensor";
+    cmp["ent_cat"] = "diagnostic";
+    cmp["dev_cla"] = "duration";
+    cmp["unit_of_meas"] = "s";
+    cmp["stat_cla"] = "measurement";
+    cmp["uniq_id"] = String("shed_sensor_hub_") + key;
+    cmp["object_id"] = String("shed_") + key;
+    cmp["stat_t"] = state_topic;                             // home/shed/sensor/<key>/state
+    cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;          // devices/shed_sensor_hub/status
+}
+
+// Sensor computed on-device from the raw readings; shares its source sensor's availability
+void add_derived_sensor(JsonObject cmps, const char* key, const char* name, const char* device_class,
+                        const char* unit, const char* state_topic, const char* source_availability_topic) {
+    JsonObject cmp = cmps[String("shed_") + key].to<JsonObject>();
+    cmp["name"] = name;
+    cmp["p"] = "sensor";
+    if (device_class != nullptr) {
+        cmp["dev_cla"] = device_class;
+    }
+    cmp["unit_of_meas"] = unit;
+    cmp["stat_cla"] = "measurement";
+    cmp["uniq_id"] = String("shed_sensor_hub_") + key;
+    cmp["object_id"] = String("shed_") + key;
+    cmp["stat_t"] = state_topic;                             // home/shed/sensor/<key>/state
+    add_sensor_availability(cmp, source_availability_topic);
+    cmp["val_tpl"] = "{{ value | float }}";                  // Ensure the value is treated as a float
+}
+
+bool mqtt_discovery(bool force) {
 
     // Build and publish discovery json for the device and all components
     JsonDocument discovery_doc;
-    const char* discovery_topic = "homeassistant/device/shed_sensor_hub/config"; // Unique topic for this device
+    const char* discovery_topic = MQTT_TOPIC_DEVICE_DISCOVERY; // Unique topic for this device
 
     // Device document
     JsonObject device_doc = discovery_doc["device"].to<JsonObject>();
@@ -108,7 +173,7 @@ void mqtt_discovery() {
     temp_sensor_cmp["uniq_id"] = "shed_sensor_hub_temp_sensor";
     temp_sensor_cmp["object_id"] = "shed_temp_sensor";
     temp_sensor_cmp["stat_t"] = MQTT_TOPIC_TEMPERATURE_SHED_STATE;      // home/shed/sensor/temperature/state
-    temp_sensor_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;    // devices/shed_sensor_hub/status
+    add_sensor_availability(temp_sensor_cmp, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
     temp_sensor_cmp["val_tpl"] = "{{ value | float }}";          // Ensure the value is treated as a float
 
     // Humidity Sensor (%)
@@ -121,7 +186,7 @@ void mqtt_discovery() {
     humidity_sensor_cmp["uniq_id"] = "shed_sensor_hub_humidity_sensor";
     humidity_sensor_cmp["object_id"] = "shed_humidity_sensor";
     humidity_sensor_cmp["stat_t"] = MQTT_TOPIC_HUMIDITY_SHED_STATE;      // home/shed/sensor/humidity/state
-    humidity_sensor_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;  // devices/shed_sensor_hub/status
+    add_sensor_availability(humidity_sensor_cmp, MQTT_TOPIC_HUMIDITY_SHED_AVAILABILITY);
     humidity_sensor_cmp["val_tpl"] = "{{ value | float }}";          // Ensure the value is treated as a float
 
     // Pressure Sensor (hPa)
@@ -134,7 +199,7 @@ void mqtt_discovery() {
     pressure_sensor_cmp["uniq_id"] = "shed_sensor_hub_pressure_sensor";
     pressure_sensor_cmp["object_id"] = "shed_pressure_sensor";
     pressure_sensor_cmp["stat_t"] = MQTT_TOPIC_PRESSURE_SHED_STATE;      // home/shed/sensor/pressure/state
-    pressure_sensor_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;  // devices/shed_sensor_hub/status
+    add_sensor_availability(pressure_sensor_cmp, MQTT_TOPIC_PRESSURE_SHED_AVAILABILITY);
     pressure_sensor_cmp["val_tpl"] = "{{ value | float }}";          // Ensure the value is treated as a float
 
     // Ambient Light Sensor (lux)
@@ -147,29 +212,133 @@ void mqtt_discovery() {
     lux_sensor_cmp["uniq_id"] = "shed_sensor_hub_lux_sensor";
     lux_sensor_cmp["object_id"] = "shed_lux_sensor";
     lux_sensor_cmp["stat_t"] = MQTT_TOPIC_LUX_SHED_STATE;            // home/shed/sensor/lux/state
-    lux_sensor_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;  // devices/shed_sensor_hub/status
+    add_sensor_availability(lux_sensor_cmp, MQTT_TOPIC_LUX_SHED_AVAILABILITY);
     lux_sensor_cmp["val_tpl"] = "{{ value | float }}";          // Ensure the value is treated as a float
 
-    // Print the JSON document to Serial for debugging
+    // Derived metrics (computed on-device)
+    add_derived_sensor(cmps_doc, "dew_point", "Shed Dew Point", "temperature", "°F",
+                       MQTT_TOPIC_DEW_POINT_SHED_STATE, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
+    add_derived_sensor(cmps_doc, "heat_index", "Shed Heat Index", "temperature", "°F",
+                       MQTT_TOPIC_HEAT_INDEX_SHED_STATE, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
+    add_derived_sensor(cmps_doc, "temperature_24h_min", "Shed Temperature 24h Min", "temperature", "°F",
+                       MQTT_TOPIC_TEMPERATURE_24H_MIN_SHED_STATE, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
+    add_derived_sensor(cmps_doc, "temperature_24h_max", "Shed Temperature 24h Max", "temperature", "°F",
+                       MQTT_TOPIC_TEMPERATURE_24H_MAX_SHED_STATE, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
+    add_derived_sensor(cmps_doc, "temperature_24h_mean", "Shed Temperature 24h Mean", "temperature", "°F",
+                       MQTT_TOPIC_TEMPERATURE_24H_MEAN_SHED_STATE, MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY);
+    add_derived_sensor(cmps_doc, "pressure_tendency", "Shed Pressure Tendency (3h)", nullptr, "hPa",
+                       MQTT_TOPIC_PRESSURE_TENDENCY_SHED_STATE, MQTT_TOPIC_PRESSURE_SHED_AVAILABILITY);
+
+    // Boot Timing (diagnostic)
+    JsonObject boot_time_cmp = cmps_doc["shed_boot_time"].to<JsonObject>();
+    boot_time_cmp["name"] = "Shed Boot Time to Online";
+    boot_time_cmp["p"] = "sensor";
+    boot_time_cmp["ent_cat"] = "diagnostic";
+    boot_time_cmp["dev_cla"] = "duration";
+    boot_time_cmp["unit_of_meas"] = "ms";
+    boot_time_cmp["uniq_id"] = "shed_sensor_hub_boot_time";
+    boot_time_cmp["object_id"] = "shed_boot_time";
+    boot_time_cmp["stat_t"] = MQTT_TOPIC_BOOT_TIME_STATE;              // home/shed/sensor/boot_time/state
+    boot_time_cmp["json_attr_t"] = MQTT_TOPIC_BOOT_TIME_ATTRIBUTES;    // home/shed/sensor/boot_time/attributes
+    boot_time_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;         // devices/shed_sensor_hub/status
+
+    // MQTT Load (diagnostic)
+    JsonObject mqtt_load_cmp = cmps_doc["shed_mqtt_load"].to<JsonObject>();
+    mqtt_load_cmp["name"] = "Shed MQTT Messages per Minute";
+    mqtt_load_cmp["p"] = "sensor";
+    mqtt_load_cmp["ent_cat"] = "diagnostic";
+    mqtt_load_cmp["unit_of_meas"] = "msg/min";
+    mqtt_load_cmp["stat_cla"] = "measurement";
+    mqtt_load_cmp["uniq_id"] = "shed_sensor_hub_mqtt_load";
+    mqtt_load_cmp["object_id"] = "shed_mqtt_load";
+    mqtt_load_cmp["stat_t"] = MQTT_TOPIC_MQTT_LOAD_STATE;              // home/shed/sensor/mqtt_load/state
+    mqtt_load_cmp["json_attr_t"] = MQTT_TOPIC_MQTT_LOAD_ATTRIBUTES;    // home/shed/sensor/mqtt_load/attributes
+    mqtt_load_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;         // devices/shed_sensor_hub/status
+
+    // I2C Bus Health (diagnostic)
+    JsonObject i2c_health_cmp = cmps_doc["shed_i2c_health"].to<JsonObject>();
+    i2c_health_cmp["name"] = "Shed I2C Sensors Online";
+    i2c_health_cmp["p"] = "sensor";
+    i2c_health_cmp["ent_cat"] = "diagnostic";
+    i2c_health_cmp["stat_cla"] = "measurement";
+    i2c_health_cmp["uniq_id"] = "shed_sensor_hub_i2c_health";
+    i2c_health_cmp["object_id"] = "shed_i2c_health";
+    i2c_health_cmp["stat_t"] = MQTT_TOPIC_I2C_HEALTH_STATE;            // home/shed/sensor/i2c_health/state
+    i2c_health_cmp["json_attr_t"] = MQTT_TOPIC_I2C_HEALTH_ATTRIBUTES;  // home/shed/sensor/i2c_health/attributes
+    i2c_health_cmp["avty_t"] = MQTT_TOPIC_DEVICE_AVAILABILITY;        // devices/shed_sensor_hub/status
+
+    // Adaptive sampling bounds (config) and effective intervals (diagnostic)
+    add_sample_bound_number(cmps_doc, "climate_sample_min", "Shed Climate Sample Min", MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MIN);
+    add_sample_bound_number(cmps_doc, "climate_sample_max", "Shed Climate Sample Max", MQTT_BASE_TOPIC_CLIMATE_SAMPLE_MAX);
+    add_sample_bound_number(cmps_doc, "pressure_sample_min", "Shed Pressure Sample Min", MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MIN);
+    add_sample_bound_number(cmps_doc, "pressure_sample_max", "Shed Pressure Sample Max", MQTT_BASE_TOPIC_PRESSURE_SAMPLE_MAX);
+    add_sample_bound_number(cmps_doc, "lux_sample_min", "Shed Lux Sample Min", MQTT_BASE_TOPIC_LUX_SAMPLE_MIN);
+    add_sample_bound_number(cmps_doc, "lux_sample_max", "Shed Lux Sample Max", MQTT_BASE_TOPIC_LUX_SAMPLE_MAX);
+    add_sample_interval_sensor(cmps_doc, "climate_sample_interval", "Shed Climate Sample Interval", MQTT_TOPIC_CLIMATE_SAMPLE_INTERVAL_STATE);
+    add_sample_interval_sensor(cmps_doc, "pressure_sample_interval", "Shed Pressure Sample Interval", MQTT_TOPIC_PRESSURE_SAMPLE_INTERVAL_STATE);
+    add_sample_interval_sensor(cmps_doc, "lux_sample_interval", "Shed Lux Sample Interval", MQTT_TOPIC_LUX_SAMPLE_INTERVAL_STATE);
+
+    // The whole PUBLISH packet (fixed header, topic length, topic, payload)
+    // has to fit PubSubClient's buffer, both going out and echoed back
+    size_t jsonSize = measureJson(discovery_doc);
+    size_t packetSize = MQTT_MAX_HEADER_SIZE + 2 + strlen(discovery_topic) + jsonSize;
+    if (packetSize > DEVICE_DISCOVERY_PAYLOAD_SIZE) {
+        Serial.print("Error: discovery packet exceeds MQTT buffer size: ");
+        Serial.println(packetSize);
+        return true; // Retrying can't help
+    }
+
+    static char buffer[DEVICE_DISCOVERY_PAYLOAD_SIZE];
+    size_t length = serializeJson(discovery_doc, buffer, sizeof(buffer));
+
+    // The broker keeps the document retained, so skip it if nothing changed since it was last confirmed
+    uint32_t hash = fnv1a_hash(buffer, length);
+    if (!force && hash == load_discovery_hash()) {
+        Serial.println("Discovery document unchanged, not republishing.");
+        return true;
+    }
+
+    Serial.println("Publishing discovery document to MQTT broker...");
+    if (!client.publish(discovery_topic, buffer, true)) {
+        Serial.println("Error: discovery publish failed, will retry.");
+        return false;
+    }
+
+    // Print the JSON document to Serial for debugging, once per successful
+    // publish (it's ~10 KB, about a second of blocking at 115200 baud)
     Serial.println("--- MQTT Discovery Payload ---");
     serializeJsonPretty(discovery_doc, Serial);
     Serial.println();
     Serial.print("Discovery Topic: ");
     Serial.println(discovery_topic);
-
-    // Print the total size of the JSON document
-    size_t jsonSize = measureJson(discovery_doc);
     Serial.println("--------------------------------");
     Serial.print("Total JSON size: ");
     Serial.println(jsonSize);
     Serial.println("--------------------------------");
 
-    if (jsonSize < DEVICE_DISCOVERY_PAYLOAD_SIZE) {
-        Serial.println("Publishing discovery document to MQTT broker...");
-        static char buffer[DEVICE_DISCOVERY_PAYLOAD_SIZE];
-        serializeJson(discovery_doc, buffer);
-        client.publish(discovery_topic, buffer, true);
-    } else {
-        Serial.println("Error: JSON document size exceeds buffer size.");
+    // The broker processes our packets in order, so the retained copy this
+    // subscription returns is ours only if the publish was actually stored
+    pendingDiscoveryHash = hash;
+    discoveryConfirmPending = true;
+    client.subscribe(discovery_topic);
+    return true;
+}
+
+void handle_discovery_echo(const byte* payload, unsigned int length) {
+    if (!discoveryConfirmPending) {
+        return;
     }
-}
\ No newline at end of file
+
+    uint32_t hash = fnv1a_hash((const char*)payload, length);
+    if (hash != pendingDiscoveryHash) {
+        // Stale retained document: the publish never made it. Leave the hash
+        // unsaved so the next connection republishes.
+        Serial.println("Broker returned a different discovery document, not confirmed.");
+        return;
+    }
+
+    discoveryConfirmPending = false;
+    client.unsubscribe(MQTT_TOPIC_DEVICE_DISCOVERY);
+    save_discovery_hash(hash);
+    Serial.println("Discovery document confirmed by broker.");
+}
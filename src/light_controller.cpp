@@ -2,9 +2,11 @@
 // #include <Wire.h>
 // #include <Adafruit_VEML7700.h>
 #include <PubSubClient.h>
+#include <string.h>
 #include "light_controller.h"
 #include "config.h"
 #include "connections.h" // For the global 'client' object
+#include "net_metrics.h" // For command handling latency
 
 extern PubSubClient client;
 
@@ -17,6 +19,16 @@ unsigned long lightOnTime = 0;
 int pirState = LOW;
 int lastPirState = LOW;
 unsigned long lastTimerRemainingPublishTime = 0;
+unsigned long firstRelayActionTime = 0; // millis() of the first relay switch since boot, 0 until then
+unsigned long lightCommandTimeUs = 0;   // micros() of the last light command not yet acted on, 0 if none
+
+// --- Command Acknowledgement ---
+// A light command may carry a sender token ("ON#1234"). Once loop() has
+// processed the command, the token is echoed on MQTT_TOPIC_LIGHT_ACK with the
+// resulting relay state, so the sender can time the full round trip (broker,
+// network, loop() and relay) on its own clock.
+const unsigned int LIGHT_ACK_TOKEN_MAX = 16;
+char lightAckToken[LIGHT_ACK_TOKEN_MAX + 1] = ""; // Empty if no acknowledgement is owed
 
 // --- Timer Durations ---
 unsigned long motionTimerDuration = INITIAL_MOTION_TIMER_DURATION_MS;
@@ -30,6 +42,8 @@ unsigned long manualTimerDuration = INITIAL_MANUAL_TIMER_DURATION_MS;
 
 // --- Private Function Prototypes ---
 unsigned long get_current_timer_duration();
+void record_relay_switch();
+void publish_light_ack();
 
 // --- Setup Function ---
 void setup_light_controller() {
@@ -50,7 +64,6 @@ void setup_light_controller() {
     // veml.setIntegrationTime(VEML7700_IT_100MS);
   // }
   Serial.println("Light Controller Initialized.");
-  delay(500); // Pause for serial monitor
 }
 
 // --- Main Loop Function ---
@@ -91,6 +104,13 @@ void loop_light_controller() {
     lightOnTime = millis();
     Serial.println(lightManualOverride ? "Manual override: Turning relay ON." : "Occupancy detected: Turning relay ON.");
     digitalWrite(LIGHT_RELAY_PIN, HIGH);
+    record_relay_switch();
+    if (firstRelayActionTime == 0) {
+      firstRelayActionTime = millis();
+      Serial.print("Time to first relay action: ");
+      Serial.print(firstRelayActionTime);
+      Serial.println(" ms");
+    }
     if (!lightManualOverride) {
       client.publish(MQTT_TOPIC_OCCUPANCY_STATE, MQTT_PAYLOAD_ON, true);
     }
@@ -101,6 +121,7 @@ void loop_light_controller() {
     lightIsOn = false;
     Serial.println("No occupancy: Turning relay OFF.");
     digitalWrite(LIGHT_RELAY_PIN, LOW);
+    record_relay_switch();
     client.publish(MQTT_TOPIC_OCCUPANCY_STATE, MQTT_PAYLOAD_OFF, true);
     client.publish(MQTT_TOPIC_LIGHT_STATE, MQTT_PAYLOAD_OFF, true);
 
@@ -114,6 +135,12 @@ void loop_light_controller() {
     }
   }
 
+  // A light command that didn't change the relay (e.g. ON while already on) isn't a latency sample
+  lightCommandTimeUs = 0;
+  // The command has been processed either way; the ack reports the relay state
+  // it left, which may differ from the command (e.g. OFF while motion holds it on)
+  publish_light_ack();
+
   // Publish the remaining time for UI but only if the light is on
   if (lightIsOn) {
     if (millis() - lastTimerRemainingPublishTime > 1000) { // Every second
@@ -128,6 +155,18 @@ void loop_light_controller() {
 
 // --- MQTT Command Handlers ---
 void handle_light_command(String message) {
+  lightCommandTimeUs = micros();
+
+  // Split off an optional sender token
+  int tokenStart = message.indexOf('#');
+  if (tokenStart >= 0) {
+    String token = message.substring(tokenStart + 1);
+    if (token.length() > 0 && token.length() <= LIGHT_ACK_TOKEN_MAX) {
+      strcpy(lightAckToken, token.c_str());
+    }
+    message = message.substring(0, tokenStart);
+  }
+
   message.toUpperCase();
   if (message == "ON") {
     lightManualOverride = true;
@@ -174,6 +213,33 @@ void handle_manual_timer_command(String message) {
 }
 
 // --- Private Helper Functions ---
+// On-device part only: from handle_light_command() to the relay pin changing.
+// Broker and network time are seen only by the sender, via the ack token.
+void record_relay_switch() {
+  if (lightCommandTimeUs != 0) {
+    record_command_latency(micros() - lightCommandTimeUs);
+    lightCommandTimeUs = 0;
+  }
+}
+
+void publish_light_ack() {
+  if (lightAckToken[0] == '\0') {
+    return;
+  }
+  char payload[LIGHT_ACK_TOKEN_MAX + 5];
+  snprintf(payload, sizeof(payload), "%s %s", lightAckToken, lightIsOn ? MQTT_PAYLOAD_ON : MQTT_PAYLOAD_OFF);
+  client.publish(MQTT_TOPIC_LIGHT_ACK, payload);
+  lightAckToken[0] = '\0';
+}
+
 unsigned long get_current_timer_duration() {
   return lightManualOverride ? manualTimerDuration : motionTimerDuration;
 }
+
+unsigned long get_first_relay_action_ms() {
+  return firstRelayActionTime;
+}
+
+bool is_occupied() {
+  return lightIsOn || pirState == HIGH;
+}
@@ -7,6 +7,9 @@
 #include "connections.h"
 #include "light_controller.h"
 #include "sensors.h"
+#include "sensor_health.h"
+#include "derived_metrics.h"
+#include "net_metrics.h"
 
 // --- Global Objects ---
 WiFiClient espClient;
@@ -18,11 +21,10 @@ unsigned long lastMqttReconnectAttempt = 0;
 void setup() {
   Serial.begin(115200);
 
-  setup_light_controller(); // Set up the pins and sensors for the light controller
+  setup_light_controller(); // PIR and relay first so the light works before the network is up
+  setup_wifi(); // Starts connecting in the background, loop_wifi() finishes it
   setup_environmental_sensors(); // Set up environmental sensors
 
-  setup_wifi();
-  
   // Configure MQTT client
   client.setServer(MQTT_SERVER, 1883);
   client.setBufferSize(DEVICE_DISCOVERY_PAYLOAD_SIZE);
@@ -30,16 +32,26 @@ void setup() {
 }
 
 void loop() {
-  if (!client.connected()) {
-    long now = millis();
-    if (now - lastMqttReconnectAttempt > 5000) {
-      lastMqttReconnectAttempt = now;
-      reconnect();
+  loop_wifi();
+
+  // While Wi-Fi is down the light controller and sensors below keep running
+  if (WiFi.status() == WL_CONNECTED) {
+    if (!client.connected()) {
+      long now = millis();
+      // First attempt goes out as soon as Wi-Fi is up, then every 5 seconds
+      if (lastMqttReconnectAttempt == 0 || now - lastMqttReconnectAttempt > 5000) {
+        lastMqttReconnectAttempt = now;
+        reconnect();
+      }
+    } else {
+      client.loop();
+      loop_mqtt_deferred(); // Discovery and boot metrics once state is out
     }
-  } else {
-    client.loop();
   }
 
   loop_light_controller(); // Run the core logic for the light controller
   read_environmental_sensors(); // Read environmental sensors
+  loop_sensor_health(); // Publish I2C bus diagnostics
+  loop_derived_metrics(); // Publish rolling statistics
+  loop_net_metrics(); // Publish MQTT load metrics
 }
@@ -0,0 +1,87 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <PubSubClient.h>
+#include <algorithm>
+#include <string.h>
+#include "net_metrics.h"
+#include "config.h"
+
+extern PubSubClient client;
+
+// --- Non-Blocking Timers ---
+unsigned long lastNetMetricsPublishTime = 0;
+const unsigned long NET_METRICS_PUBLISH_INTERVAL = 60000; // Publish load metrics every minute
+
+// --- Counters ---
+unsigned long messagesTotal = 0;
+unsigned long messagesRejected = 0;
+unsigned long messagesThisInterval = 0;
+
+// --- Command Handling Latency ---
+// handle_light_command() to relay switch, on-device only. Ring of the most
+// recent samples; percentiles are taken over these
+const int LATENCY_SAMPLE_COUNT = 64;
+unsigned long latencySamples[LATENCY_SAMPLE_COUNT];
+int latencySampleHead = 0;
+int latencySampleCount = 0;
+
+// --- Private Helper Functions ---
+// Nearest-rank percentile over an already sorted array
+unsigned long percentile(const unsigned long* sorted, int count, int pct) {
+  int rank = (pct * count + 99) / 100;
+  return sorted[max(rank, 1) - 1];
+}
+
+void publish_net_metrics(unsigned long elapsedMs) {
+  JsonDocument attributes;
+  attributes["messages_total"] = messagesTotal;
+  attributes["messages_rejected"] = messagesRejected;
+  attributes["free_heap"] = ESP.getFreeHeap();
+  attributes["min_free_heap"] = ESP.getMinFreeHeap(); // Heap high-water mark since boot
+
+  if (latencySampleCount > 0) {
+    unsigned long sorted[LATENCY_SAMPLE_COUNT];
+    memcpy(sorted, latencySamples, latencySampleCount * sizeof(unsigned long));
+    std::sort(sorted, sorted + latencySampleCount);
+    attributes["handling_samples"] = latencySampleCount;
+    attributes["handling_p50_ms"] = percentile(sorted, latencySampleCount, 50) / 1000.0;
+    attributes["handling_p95_ms"] = percentile(sorted, latencySampleCount, 95) / 1000.0;
+    attributes["handling_p99_ms"] = percentile(sorted, latencySampleCount, 99) / 1000.0;
+    attributes["handling_max_ms"] = sorted[latencySampleCount - 1] / 1000.0;
+  }
+
+  char buffer[384];
+  serializeJson(attributes, buffer);
+  client.publish(MQTT_TOPIC_MQTT_LOAD_ATTRIBUTES, buffer, true);
+
+  float perMinute = messagesThisInterval * 60000.0 / elapsedMs;
+  client.publish(MQTT_TOPIC_MQTT_LOAD_STATE, String(perMinute, 1).c_str(), true);
+}
+
+// --- Recording ---
+void record_mqtt_message() {
+  messagesTotal++;
+  messagesThisInterval++;
+}
+
+void record_mqtt_message_rejected() {
+  messagesRejected++;
+}
+
+void record_command_latency(unsigned long latencyUs) {
+  latencySamples[latencySampleHead] = latencyUs;
+  latencySampleHead = (latencySampleHead + 1) % LATENCY_SAMPLE_COUNT;
+  if (latencySampleCount < LATENCY_SAMPLE_COUNT) {
+    latencySampleCount++;
+  }
+}
+
+// --- Main Loop Function ---
+void loop_net_metrics() {
+  unsigned long elapsed = millis() - lastNetMetricsPublishTime;
+  if (elapsed >= NET_METRICS_PUBLISH_INTERVAL) {
+    lastNetMetricsPublishTime = millis();
+    publish_net_metrics(elapsed);
+    messagesThisInterval = 0;
+  }
+}
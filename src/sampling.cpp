@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include <PubSubClient.h>
+#include "sampling.h"
+#include "config.h"
+#include "light_controller.h" // For occupancy-driven lux sampling
+
+extern PubSubClient client;
+
+// --- Scheduler Tuning ---
+// Volatility is the EWMA RMS of each step, measured in units of the signal's
+// change threshold. Below CALM the interval stretches, above BUSY it shrinks,
+// and a single step past the threshold snaps straight to the minimum.
+const float VOLATILITY_ALPHA = 0.3;
+const float VOLATILITY_CALM = 0.25;
+const float VOLATILITY_BUSY = 0.5;
+
+struct SignalTracker {
+  float changeThreshold;   // Absolute step considered significant
+  float relativeThreshold; // Optional fraction of the last value (0 = unused)
+  float lastValue;
+  bool hasValue;
+  float meanSquareScore;
+};
+
+struct SamplingChannel {
+  const char* name;
+  unsigned long minIntervalMs;
+  unsigned long maxIntervalMs;
+  unsigned long intervalMs;
+  unsigned long lastSampleTime;
+  unsigned long publishedIntervalMs;
+  bool followsOccupancy;
+  bool wasOccupied;
+  SignalTracker signals[SAMPLE_SIGNAL_COUNT];
+  const char* minStateTopic;
+  const char* minCommandTopic;
+  const char* maxStateTopic;
+  const char* maxCommandTopic;
+  const char* intervalStateTopic;
+};
+
+SamplingChannel channels[SAMPLE_CHANNEL_COUNT] = {
+  // Temperature (0.3 °F) and humidity (1 %) sampled every 5 s - 5 min
+  { "climate", 5000, 300000, 5000, 0, 0, false, false,
+    { { 0.3, 0.0 }, { 1.0, 0.0 } },
+    MQTT_TOPIC_CLIMATE_SAMPLE_MIN_STATE, MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND,
+    MQTT_TOPIC_CLIMATE_SAMPLE_MAX_STATE, MQTT_TOPIC_CLIMATE_SAMPLE_MAX_COMMAND,
+    MQTT_TOPIC_CLIMATE_SAMPLE_INTERVAL_STATE },
+  // Pressure (0.2 hPa) sampled every 10 s - 10 min
+  { "pressure", 10000, 600000, 10000, 0, 0, false, false,
+    { { 0.2, 0.0 }, { 0.0, 0.0 } },
+    MQTT_TOPIC_PRESSURE_SAMPLE_MIN_STATE, MQTT_TOPIC_PRESSURE_SAMPLE_MIN_COMMAND,
+    MQTT_TOPIC_PRESSURE_SAMPLE_MAX_STATE, MQTT_TOPIC_PRESSURE_SAMPLE_MAX_COMMAND,
+    MQTT_TOPIC_PRESSURE_SAMPLE_INTERVAL_STATE },
+  // Lux (5 lx or 10 %, whichever is larger) sampled every 1 s - 1 min, at the minimum while occupied
+  { "lux", 1000, 60000, 1000, 0, 0, true, false,
+    { { 5.0, 0.1 }, { 0.0, 0.0 } },
+    MQTT_TOPIC_LUX_SAMPLE_MIN_STATE, MQTT_TOPIC_LUX_SAMPLE_MIN_COMMAND,
+    MQTT_TOPIC_LUX_SAMPLE_MAX_STATE, MQTT_TOPIC_LUX_SAMPLE_MAX_COMMAND,
+    MQTT_TOPIC_LUX_SAMPLE_INTERVAL_STATE },
+};
+
+// --- Private Helper Functions ---
+unsigned long effective_interval(const SamplingChannel& ch) {
+  if (ch.followsOccupancy && is_occupied()) {
+    return ch.minIntervalMs;
+  }
+  return ch.intervalMs;
+}
+
+void publish_interval(SamplingChannel& ch) {
+  unsigned long interval = effective_interval(ch);
+  char payload[12];
+  dtostrf(interval / 1000.0, 1, 1, payload);
+  if (client.publish(ch.intervalStateTopic, payload, true)) {
+    ch.publishedIntervalMs = interval;
+  }
+}
+
+void publish_bound(const char* topic, unsigned long valueMs) {
+  client.publish(topic, String(valueMs / 1000).c_str(), true);
+}
+
+// --- Scheduling ---
+bool sample_due(SampleChannel index) {
+  SamplingChannel& ch = channels[index];
+  unsigned long now = millis();
+
+  // Sample immediately when someone walks in, so a fresh lux reading is
+  // published as soon as occupancy starts
+  bool occupied = ch.followsOccupancy && is_occupied();
+  bool justOccupied = occupied && !ch.wasOccupied;
+  ch.wasOccupied = occupied;
+
+  if (ch.publishedIntervalMs != effective_interval(ch)) {
+    publish_interval(ch);
+  }
+
+  if (!justOccupied && now - ch.lastSampleTime < effective_interval(ch)) {
+    return false;
+  }
+  ch.lastSampleTime = now;
+  return true;
+}
+
+void sample_record(SampleChannel index, float value, SampleSignal signalIndex) {
+  SamplingChannel& ch = channels[index];
+  SignalTracker& signal = ch.signals[signalIndex];
+
+  if (!signal.hasValue) {
+    signal.lastValue = value;
+    signal.hasValue = true;
+    return;
+  }
+
+  float threshold = max(signal.changeThreshold, signal.relativeThreshold * fabsf(signal.lastValue));
+  float score = fabsf(value - signal.lastValue) / threshold;
+  signal.lastValue = value;
+  signal.meanSquareScore += VOLATILITY_ALPHA * (score * score - signal.meanSquareScore);
+
+  // The most volatile signal in the channel decides its rate
+  float volatility = 0.0;
+  for (const SignalTracker& s : ch.signals) {
+    if (s.hasValue) {
+      volatility = max(volatility, sqrtf(s.meanSquareScore));
+    }
+  }
+
+  if (score >= 1.0) {
+    ch.intervalMs = ch.minIntervalMs;
+  } else if (volatility > VOLATILITY_BUSY) {
+    ch.intervalMs = max(ch.intervalMs / 2, ch.minIntervalMs);
+  } else if (volatility < VOLATILITY_CALM) {
+    ch.intervalMs = min(ch.intervalMs + ch.intervalMs / 2, ch.maxIntervalMs);
+  }
+}
+
+// --- MQTT Command Handler ---
+bool handle_sampling_command(const String& topic, String message) {
+  for (SamplingChannel& ch : channels) {
+    bool isMin = (topic == ch.minCommandTopic);
+    bool isMax = (topic == ch.maxCommandTopic);
+    if (!isMin && !isMax) {
+      continue;
+    }
+
+    unsigned long newBoundSec = message.toInt();
+    unsigned long newBoundMs = newBoundSec * 1000;
+    bool inRange = newBoundSec >= SAMPLE_BOUND_MIN_SEC && newBoundSec <= SAMPLE_BOUND_MAX_SEC;
+    bool ordered = isMin ? newBoundMs <= ch.maxIntervalMs : newBoundMs >= ch.minIntervalMs;
+    if (!inRange || !ordered) {
+      Serial.print("Received invalid ");
+      Serial.print(ch.name);
+      Serial.println(isMin ? " sample minimum. Must be 1-3600 seconds and not above the maximum."
+                           : " sample maximum. Must be 1-3600 seconds and not below the minimum.");
+      return true;
+    }
+
+    if (isMin) {
+      ch.minIntervalMs = newBoundMs;
+    } else {
+      ch.maxIntervalMs = newBoundMs;
+    }
+    ch.intervalMs = constrain(ch.intervalMs, ch.minIntervalMs, ch.maxIntervalMs);
+
+    Serial.print(ch.name);
+    Serial.print(isMin ? " sample minimum updated to " : " sample maximum updated to ");
+    Serial.print(newBoundSec);
+    Serial.println(" seconds.");
+    // Acknowledge the change by publishing the new state
+    client.publish(isMin ? ch.minStateTopic : ch.maxStateTopic, message.c_str(), true);
+    return true;
+  }
+  return false;
+}
+
+void publish_sampling_state() {
+  for (SamplingChannel& ch : channels) {
+    publish_bound(ch.minStateTopic, ch.minIntervalMs);
+    publish_bound(ch.maxStateTopic, ch.maxIntervalMs);
+    publish_interval(ch);
+  }
+}
@@ -0,0 +1,241 @@
+#include <Arduino.h>
+#include <Wire.h>
+#include <ArduinoJson.h>
+#include <PubSubClient.h>
+#include "sensor_health.h"
+#include "config.h"
+
+extern PubSubClient client;
+
+// --- Supervisor Tuning ---
+const uint16_t I2C_TIMEOUT_MS = 50;                  // Upper bound on any single Wire transaction
+const uint8_t MAX_CONSECUTIVE_ERRORS = 3;            // Failed reads before a device is marked offline
+const unsigned long PROBE_BACKOFF_MIN_MS = 5000;     // First re-probe 5 seconds after failure
+const unsigned long PROBE_BACKOFF_MAX_MS = 300000;   // Back off to at most one re-probe every 5 minutes
+const unsigned long HEALTH_PUBLISH_INTERVAL = 60000; // Publish diagnostics every minute
+const float ERROR_RATE_ALPHA = 0.05;                 // Smoothing for the rolling error rate
+
+// --- Per-Device Health Tracking ---
+struct SensorHealth {
+  const char* name;
+  uint8_t address;
+  unsigned long latencyLimitUs;     // Reads slower than this count as errors
+  const char* availabilityTopics[2];
+  bool online;
+  uint8_t consecutiveErrors;
+  unsigned long reads;
+  unsigned long errors;
+  float errorRate;                  // Exponentially weighted, 0.0 - 1.0
+  unsigned long readStartUs;
+  unsigned long readElapsedUs;      // Bus time banked by sensor_pause_read()
+  unsigned long lastLatencyUs;
+  unsigned long maxLatencyUs;
+  unsigned long probeBackoff;
+  unsigned long nextProbeTime;
+};
+
+// AHT10 latency excludes the conversion wait (sensor_pause_read), so all three are bus time only.
+SensorHealth devices[SENSOR_DEVICE_COUNT] = {
+  { "aht10",    0x38, 50000,  { MQTT_TOPIC_TEMPERATURE_SHED_AVAILABILITY, MQTT_TOPIC_HUMIDITY_SHED_AVAILABILITY } },
+  { "bmp280",   0x77, 50000,  { MQTT_TOPIC_PRESSURE_SHED_AVAILABILITY, nullptr } },
+  { "veml7700", 0x10, 50000,  { MQTT_TOPIC_LUX_SHED_AVAILABILITY, nullptr } },
+};
+
+unsigned long busRecoveries = 0;
+unsigned long lastHealthPublishTime = 0;
+
+// --- Private Helper Functions ---
+void publish_device_availability(const SensorHealth& device) {
+  const char* payload = device.online ? MQTT_PAYLOAD_ONLINE : MQTT_PAYLOAD_OFFLINE;
+  for (const char* topic : device.availabilityTopics) {
+    if (topic != nullptr) {
+      client.publish(topic, payload, true);
+    }
+  }
+}
+
+void set_device_online(SensorHealth& device, bool online) {
+  if (device.online == online) {
+    return;
+  }
+  device.online = online;
+  Serial.print("Sensor ");
+  Serial.print(device.name);
+  Serial.println(online ? " is back online." : " marked offline, entering degraded mode.");
+  publish_device_availability(device);
+}
+
+// A slave that lost clock mid-byte holds SDA low forever. Clock SCL until it
+// lets go (at most 9 pulses), then issue a STOP and hand the pins back to Wire.
+void i2c_bus_recover() {
+  Serial.println("I2C bus stuck (SDA low), clocking SCL to release it...");
+  Wire.end();
+
+  pinMode(SDA, INPUT_PULLUP);
+  pinMode(SCL, OUTPUT_OPEN_DRAIN);
+  digitalWrite(SCL, HIGH);
+  delayMicroseconds(5);
+
+  for (int i = 0; i < 9 && digitalRead(SDA) == LOW; i++) {
+    digitalWrite(SCL, LOW);
+    delayMicroseconds(5);
+    digitalWrite(SCL, HIGH);
+    delayMicroseconds(5);
+  }
+
+  // STOP condition: SDA rises while SCL is high
+  pinMode(SDA, OUTPUT_OPEN_DRAIN);
+  digitalWrite(SDA, LOW);
+  delayMicroseconds(5);
+  digitalWrite(SCL, HIGH);
+  delayMicroseconds(5);
+  digitalWrite(SDA, HIGH);
+  delayMicroseconds(5);
+
+  Wire.begin();
+  Wire.setTimeOut(I2C_TIMEOUT_MS);
+  busRecoveries++;
+}
+
+void record_error(SensorHealth& device) {
+  device.errors++;
+  device.errorRate += ERROR_RATE_ALPHA * (1.0 - device.errorRate);
+  device.consecutiveErrors++;
+
+  // Between transactions SDA must idle high; if it doesn't, nobody on the bus can talk
+  if (digitalRead(SDA) == LOW) {
+    i2c_bus_recover();
+  }
+
+  if (device.consecutiveErrors >= MAX_CONSECUTIVE_ERRORS) {
+    device.probeBackoff = PROBE_BACKOFF_MIN_MS;
+    device.nextProbeTime = millis() + device.probeBackoff;
+    set_device_online(device, false);
+  }
+}
+
+void publish_health() {
+  JsonDocument attributes;
+  int onlineCount = 0;
+  for (const SensorHealth& device : devices) {
+    JsonObject dev = attributes[device.name].to<JsonObject>();
+    dev["online"] = device.online;
+    dev["reads"] = device.reads;
+    dev["errors"] = device.errors;
+    dev["error_rate"] = round(device.errorRate * 1000.0) / 10.0; // Percent, 1 decimal
+    dev["latency_ms"] = device.lastLatencyUs / 1000.0;
+    dev["max_latency_ms"] = device.maxLatencyUs / 1000.0;
+    if (device.online) {
+      onlineCount++;
+    }
+  }
+  attributes["bus_recoveries"] = busRecoveries;
+
+  char buffer[512];
+  serializeJson(attributes, buffer);
+  client.publish(MQTT_TOPIC_I2C_HEALTH_ATTRIBUTES, buffer, true);
+  client.publish(MQTT_TOPIC_I2C_HEALTH_STATE, String(onlineCount).c_str(), true);
+}
+
+// --- Setup Function ---
+void setup_sensor_health() {
+  Wire.begin();
+  Wire.setTimeOut(I2C_TIMEOUT_MS); // Never let a hung device stall the main loop
+
+  if (digitalRead(SDA) == LOW) {
+    i2c_bus_recover();
+  }
+
+  for (SensorHealth& device : devices) {
+    device.probeBackoff = PROBE_BACKOFF_MIN_MS;
+  }
+}
+
+// --- Main Loop Function ---
+void loop_sensor_health() {
+  if (millis() - lastHealthPublishTime >= HEALTH_PUBLISH_INTERVAL) {
+    lastHealthPublishTime = millis();
+    publish_health();
+  }
+}
+
+// --- Read Gate ---
+bool sensor_begin_read(SensorDevice index) {
+  SensorHealth& device = devices[index];
+  if (!device.online) {
+    return false;
+  }
+
+  // Cheap address ACK before handing control to a driver that may block
+  Wire.beginTransmission(device.address);
+  if (Wire.endTransmission() != 0) {
+    device.reads++;
+    record_error(device);
+    return false;
+  }
+
+  device.readStartUs = micros();
+  device.readElapsedUs = 0;
+  return true;
+}
+
+void sensor_pause_read(SensorDevice index) {
+  SensorHealth& device = devices[index];
+  device.readElapsedUs += micros() - device.readStartUs;
+}
+
+void sensor_resume_read(SensorDevice index) {
+  devices[index].readStartUs = micros();
+}
+
+void sensor_end_read(SensorDevice index, bool valid) {
+  SensorHealth& device = devices[index];
+  unsigned long latency = device.readElapsedUs + (micros() - device.readStartUs);
+  device.reads++;
+  device.lastLatencyUs = latency;
+  if (latency > device.maxLatencyUs) {
+    device.maxLatencyUs = latency;
+  }
+
+  if (!valid || latency > device.latencyLimitUs) {
+    record_error(device);
+    return;
+  }
+
+  device.errorRate -= ERROR_RATE_ALPHA * device.errorRate;
+  device.consecutiveErrors = 0;
+}
+
+// --- Re-probe With Backoff ---
+bool sensor_probe_due(SensorDevice index) {
+  const SensorHealth& device = devices[index];
+  return !device.online && (long)(millis() - device.nextProbeTime) >= 0;
+}
+
+void sensor_record_probe(SensorDevice index, bool found) {
+  SensorHealth& device = devices[index];
+  if (found) {
+    device.consecutiveErrors = 0;
+    device.probeBackoff = PROBE_BACKOFF_MIN_MS;
+    set_device_online(device, true);
+    return;
+  }
+
+  Serial.print("Sensor ");
+  Serial.print(device.name);
+  Serial.print(" not found, next probe in ");
+  Serial.print(device.probeBackoff / 1000);
+  Serial.println(" seconds.");
+  device.nextProbeTime = millis() + device.probeBackoff;
+  device.probeBackoff = min(device.probeBackoff * 2, PROBE_BACKOFF_MAX_MS);
+}
+
+bool sensor_is_online(SensorDevice index) {
+  return devices[index].online;
+}
+
+void publish_sensor_availability() {
+  for (const SensorHealth& device : devices) {
+    publish_device_availability(device);
+  }
+}
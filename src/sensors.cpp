@@ -1,87 +1,223 @@
-#include <Adafruit_AHTX0.h>
 #include <Adafruit_BMP280.h>
 #include <Adafruit_VEML7700.h>
 #include <Wire.h>
 #include <PubSubClient.h>
 #include "config.h"
+#include "sensor_health.h"
+#include "sampling.h"
+#include "derived_metrics.h"
 
 extern PubSubClient client;
 
 // --- Sensor Objects ---
-Adafruit_AHTX0 aht;
 Adafruit_BMP280 bmp; // I2C
 Adafruit_VEML7700 veml;
 
-// --- Non-Blocking Sensor Timers ---
-unsigned long lastAHTReadTime = 0;
-unsigned long lastBMPReadTime = 0;
-unsigned long lastLUXReadTime = 0;
+// --- AHT10 (driven over Wire directly) ---
+// Adafruit_AHTX0 polls `while (getStatus() & BUSY)`, and a failed status read
+// returns 0xFF, so a device that drops off mid-conversion hangs loop() forever.
+// Instead a measurement is triggered, then collected on a later loop pass
+// with its own deadline.
+const uint8_t AHT10_ADDRESS = 0x38;
+const uint8_t AHT10_CMD_SOFT_RESET = 0xBA;
+const uint8_t AHT10_CMD_CALIBRATE = 0xE1;
+const uint8_t AHT10_CMD_TRIGGER = 0xAC;
+const uint8_t AHT10_STATUS_BUSY = 0x80;
+const uint8_t AHT10_STATUS_CALIBRATED = 0x08;
+const unsigned long AHT10_CONVERSION_MS = 80;  // Datasheet: >= 75 ms
+const unsigned long AHT10_DEADLINE_MS = 200;   // Give up and count an error after this
 
-const int ahtReadInterval = 1000; // Read AHT10 every 1 second
-const int bmpReadInterval = 1000; // Read BMP280 every 1 second
-const int luxReadInterval = 1000; // Read LUX every 1 second
+enum AhtState { AHT_IDLE, AHT_MEASURING };
+AhtState ahtState = AHT_IDLE;
+unsigned long ahtTriggerTime = 0;
+
+bool aht10_command(uint8_t command, uint8_t arg0, uint8_t arg1) {
+    Wire.beginTransmission(AHT10_ADDRESS);
+    Wire.write(command);
+    Wire.write(arg0);
+    Wire.write(arg1);
+    return Wire.endTransmission() == 0;
+}
+
+// Returns 0xFF if the status byte can't be read
+uint8_t aht10_status() {
+    if (Wire.requestFrom(AHT10_ADDRESS, (uint8_t)1) != 1) {
+        return 0xFF;
+    }
+    return Wire.read();
+}
+
+// Takes the measurement started by the last trigger; false if unreadable or still busy
+bool aht10_collect(float& temperatureC, float& humidity, bool& busy) {
+    uint8_t data[6];
+    busy = false;
+    if (Wire.requestFrom(AHT10_ADDRESS, (uint8_t)6) != 6) {
+        return false;
+    }
+    for (uint8_t& b : data) {
+        b = Wire.read();
+    }
+    if (data[0] == 0xFF) {
+        return false; // Bus floating high: nobody answered
+    }
+    if (data[0] & AHT10_STATUS_BUSY) {
+        busy = true;
+        return false;
+    }
+
+    uint32_t rawHumidity = ((uint32_t)data[1] << 12) | ((uint32_t)data[2] << 4) | (data[3] >> 4);
+    uint32_t rawTemperature = ((uint32_t)(data[3] & 0x0F) << 16) | ((uint32_t)data[4] << 8) | data[5];
+    humidity = rawHumidity * 100.0 / 1048576.0;
+    temperatureC = rawTemperature * 200.0 / 1048576.0 - 50.0;
+    return true;
+}
+
+// --- Driver Probes ---
+// Each probe initialises the device from scratch, so these double as re-probes.
+bool probe_aht10() {
+    ahtState = AHT_IDLE;
+    Wire.beginTransmission(AHT10_ADDRESS);
+    Wire.write(AHT10_CMD_SOFT_RESET);
+    if (Wire.endTransmission() != 0) {
+        return false;
+    }
+    delay(20);
+    if (!aht10_command(AHT10_CMD_CALIBRATE, 0x08, 0x00)) {
+        return false;
+    }
+
+    // Bounded wait for calibration, unlike the library's unbounded one
+    for (int i = 0; i < 10; i++) {
+        delay(10);
+        uint8_t status = aht10_status();
+        if (status == 0xFF) {
+            return false;
+        }
+        if (!(status & AHT10_STATUS_BUSY)) {
+            return status & AHT10_STATUS_CALIBRATED;
+        }
+    }
+    return false;
+}
+
+bool probe_bmp280() {
+    return bmp.begin();
+}
+
+bool probe_veml7700() {
+    if (!veml.begin()) {
+        return false;
+    }
+    veml.setGain(VEML7700_GAIN_1);
+    veml.setIntegrationTime(VEML7700_IT_100MS);
+    return true;
+}
+
+// Collects a triggered AHT10 measurement; still busy is retried until the deadline
+void poll_aht10() {
+  float temperatureC = NAN, humidity = NAN;
+  bool busy;
+  sensor_resume_read(SENSOR_AHT10);
+  bool ok = aht10_collect(temperatureC, humidity, busy);
+  if (busy && millis() - ahtTriggerTime < AHT10_DEADLINE_MS) {
+    sensor_pause_read(SENSOR_AHT10);
+    return;
+  }
+  ahtState = AHT_IDLE;
+
+  ok = ok && temperatureC >= -40.0 && temperatureC <= 85.0 && humidity >= 0.0 && humidity <= 100.0;
+  sensor_end_read(SENSOR_AHT10, ok);
+  if (ok) {
+    float temperatureF = (temperatureC * 9.0 / 5.0) + 32.0; // Convert to Fahrenheit
+    sample_record(SAMPLE_CLIMATE, temperatureF, SIGNAL_PRIMARY);
+    sample_record(SAMPLE_CLIMATE, humidity, SIGNAL_SECONDARY);
+    record_climate_reading(temperatureC, humidity);
+    client.publish(MQTT_TOPIC_TEMPERATURE_SHED_STATE, String(temperatureF).c_str());
+    client.publish(MQTT_TOPIC_HUMIDITY_SHED_STATE, String(humidity).c_str());
+  }
+}
 
 // Call this from setup()
 void setup_environmental_sensors() {
     Serial.println("Initializing Environmental Sensors...");
+    setup_sensor_health();
 
     // AHT10 Temperature and Humidity Sensor Setup
     Serial.println("Initializing AHT10 Sensor...");
-    if (!aht.begin()) {
-        Serial.println("Failed to find AHT10 chip");
-    } else {
-        Serial.println("AHT10 Initialized.");
-    }
+    bool found = probe_aht10();
+    sensor_record_probe(SENSOR_AHT10, found);
+    Serial.println(found ? "AHT10 Initialized." : "Failed to find AHT10 chip");
 
     // BMP280 Pressure Sensor Setup
     Serial.println("Initializing BMP280 Sensor...");
-    if (!bmp.begin()) {
-        Serial.println("Failed to find BMP280 chip");
-    } else {
-        Serial.println("BMP280 Initialized.");
-    }
+    found = probe_bmp280();
+    sensor_record_probe(SENSOR_BMP280, found);
+    Serial.println(found ? "BMP280 Initialized." : "Failed to find BMP280 chip");
 
     // VEML7700 Light Sensor Setup
     Serial.println("Initializing VEML7700 Sensor...");
-    if (!veml.begin()) {
-        Serial.println("Failed to find VEML7700 chip");
-    } else {
-        Serial.println("VEML7700 Initialized.");
-        veml.setGain(VEML7700_GAIN_1);
-        veml.setIntegrationTime(VEML7700_IT_100MS);
-    }
+    found = probe_veml7700();
+    sensor_record_probe(SENSOR_VEML7700, found);
+    Serial.println(found ? "VEML7700 Initialized." : "Failed to find VEML7700 chip");
+
     Serial.println("Environmental Sensors Initialized.");
-    delay(500); // Pause for serial monitor
 }
 
 // Call this from loop()
+// Sample timing is owned by the adaptive scheduler in sampling.cpp
 void read_environmental_sensors() {
-  unsigned long currentTime = millis();
-
-  // Read AHT10 Sensor
-  if (currentTime - lastAHTReadTime >= ahtReadInterval) {
-    lastAHTReadTime = currentTime;
-    sensors_event_t humidityEvent, tempEvent;
-    aht.getEvent(&humidityEvent, &tempEvent);
-    float temperatureF = (tempEvent.temperature * 9.0 / 5.0) + 32.0; // Convert to Fahrenheit
-    float humidity = humidityEvent.relative_humidity;
-    client.publish(MQTT_TOPIC_TEMPERATURE_SHED_STATE, String(temperatureF).c_str());
-    client.publish(MQTT_TOPIC_HUMIDITY_SHED_STATE, String(humidity).c_str());
+  // Re-probe any device that dropped off the bus; healthy ones are untouched
+  if (sensor_probe_due(SENSOR_AHT10)) {
+    sensor_record_probe(SENSOR_AHT10, probe_aht10());
+  }
+  if (sensor_probe_due(SENSOR_BMP280)) {
+    sensor_record_probe(SENSOR_BMP280, probe_bmp280());
+  }
+  if (sensor_probe_due(SENSOR_VEML7700)) {
+    sensor_record_probe(SENSOR_VEML7700, probe_veml7700());
+  }
+
+  // Read AHT10 Sensor: trigger now, collect on a later pass
+  if (ahtState == AHT_IDLE && sample_due(SAMPLE_CLIMATE)) {
+    if (sensor_begin_read(SENSOR_AHT10)) {
+      if (aht10_command(AHT10_CMD_TRIGGER, 0x33, 0x00)) {
+        ahtState = AHT_MEASURING;
+        ahtTriggerTime = millis();
+        sensor_pause_read(SENSOR_AHT10); // The conversion isn't bus time
+      } else {
+        sensor_end_read(SENSOR_AHT10, false);
+      }
+    }
+  } else if (ahtState == AHT_MEASURING && millis() - ahtTriggerTime >= AHT10_CONVERSION_MS) {
+    poll_aht10();
   }
 
   // Read BMP280 Sensor
-  if (currentTime - lastBMPReadTime >= bmpReadInterval) {
-    lastBMPReadTime = currentTime;
-    float pressure_hPa = bmp.readPressure() / 100.0F; // Convert to hPa
-    client.publish(MQTT_TOPIC_PRESSURE_SHED_STATE, String(pressure_hPa).c_str());
+  if (sample_due(SAMPLE_PRESSURE)) {
+    if (sensor_begin_read(SENSOR_BMP280)) {
+      float pressure_hPa = bmp.readPressure() / 100.0F; // Convert to hPa
+      bool ok = !isnan(pressure_hPa) && pressure_hPa >= 300.0 && pressure_hPa <= 1100.0;
+      sensor_end_read(SENSOR_BMP280, ok);
+      if (ok) {
+        sample_record(SAMPLE_PRESSURE, pressure_hPa);
+        record_pressure_reading(pressure_hPa);
+        client.publish(MQTT_TOPIC_PRESSURE_SHED_STATE, String(pressure_hPa).c_str());
+      }
+    }
   }
 
   // Read VEML7700 Sensor
-  if (currentTime - lastLUXReadTime >= luxReadInterval) {
-    lastLUXReadTime = currentTime;
-    float luxValue = veml.readLux();
-    char payload[10];
-    dtostrf(luxValue, 1, 2, payload);
-    client.publish(MQTT_TOPIC_LUX_SHED_STATE, payload, true);
+  if (sample_due(SAMPLE_LUX)) {
+    if (sensor_begin_read(SENSOR_VEML7700)) {
+      float luxValue = veml.readLux();
+      bool ok = !isnan(luxValue) && luxValue >= 0.0 && luxValue <= 120000.0;
+      sensor_end_read(SENSOR_VEML7700, ok);
+      if (ok) {
+        sample_record(SAMPLE_LUX, luxValue);
+        char payload[10];
+        dtostrf(luxValue, 1, 2, payload);
+        client.publish(MQTT_TOPIC_LUX_SHED_STATE, payload, true);
+      }
+    }
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,38 @@
+#include "weather_math.h"
+
+// --- Magnus Constants (Sonntag 1990, over water) ---
+const float MAGNUS_A = 17.62;
+const float MAGNUS_B = 243.12; // °C
+
+float dew_point_c(float temperatureC, float humidity) {
+  if (isnan(temperatureC) || isnan(humidity) || humidity <= 0.0) {
+    return NAN;
+  }
+  float gamma = logf(humidity / 100.0) + (MAGNUS_A * temperatureC) / (MAGNUS_B + temperatureC);
+  return (MAGNUS_B * gamma) / (MAGNUS_A - gamma);
+}
+
+float heat_index_f(float T, float RH) {
+  if (isnan(T) || isnan(RH)) {
+    return NAN;
+  }
+
+  // Steadman's simple formula, good enough while it stays below 80 °F
+  float simple = 0.5 * (T + 61.0 + ((T - 68.0) * 1.2) + (RH * 0.094));
+  if (simple < 80.0) {
+    return simple;
+  }
+
+  // Rothfusz regression
+  float hi = -42.379 + 2.04901523 * T + 10.14333127 * RH
+             - 0.22475541 * T * RH - 0.00683783 * T * T - 0.05481717 * RH * RH
+             + 0.00122874 * T * T * RH + 0.00085282 * T * RH * RH
+             - 0.00000199 * T * T * RH * RH;
+
+  if (RH < 13.0 && T >= 80.0 && T <= 112.0) {
+    hi -= ((13.0 - RH) / 4.0) * sqrtf((17.0 - fabsf(T - 95.0)) / 17.0);
+  } else if (RH > 85.0 && T >= 80.0 && T <= 87.0) {
+    hi += ((RH - 85.0) / 10.0) * ((87.0 - T) / 5.0);
+  }
+  return hi;
+}
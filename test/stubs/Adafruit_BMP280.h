@@ -0,0 +1,14 @@
+// Host stand-in: no BMP280 on the simulated bus
+
+#ifndef SIM_ADAFRUIT_BMP280_H
+#define SIM_ADAFRUIT_BMP280_H
+
+#include <Arduino.h>
+
+class Adafruit_BMP280 {
+public:
+  bool begin(uint8_t = 0x77, uint8_t = 0x58) { return false; }
+  float readPressure() { return NAN; }
+};
+
+#endif // SIM_ADAFRUIT_BMP280_H
@@ -0,0 +1,19 @@
+// Host stand-in: no VEML7700 on the simulated bus
+
+#ifndef SIM_ADAFRUIT_VEML7700_H
+#define SIM_ADAFRUIT_VEML7700_H
+
+#include <Arduino.h>
+
+#define VEML7700_GAIN_1 0x00
+#define VEML7700_IT_100MS 0x00
+
+class Adafruit_VEML7700 {
+public:
+  bool begin() { return false; }
+  void setGain(uint8_t) {}
+  void setIntegrationTime(uint8_t) {}
+  float readLux() { return NAN; }
+};
+
+#endif // SIM_ADAFRUIT_VEML7700_H
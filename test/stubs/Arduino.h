@@ -0,0 +1,142 @@
+// Host stand-in for the Arduino-ESP32 core, just enough to build the firmware
+// sources natively. Time is simulated: nothing advances sim_micros except the
+// harness and the calls that block on real hardware (delay, Serial, connect).
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include "WString.h"
+
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+#define LED_BUILTIN 15
+static const uint8_t SDA = 22;
+static const uint8_t SCL = 23;
+
+using std::min;
+using std::max;
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// --- Simulated Clock ---
+inline uint64_t sim_micros = 0;
+
+inline void sim_advance_us(uint64_t us) { sim_micros += us; }
+inline unsigned long millis() { return (unsigned long)(sim_micros / 1000); }
+inline unsigned long micros() { return (unsigned long)sim_micros; }
+inline void delay(unsigned long ms) { sim_advance_us((uint64_t)ms * 1000); }
+inline void delayMicroseconds(unsigned int us) { sim_advance_us(us); }
+
+// --- GPIO ---
+// Levels the firmware reads back; SDA/SCL idle high on the pulled-up bus
+inline int sim_pin_level[64] = {};
+inline bool sim_pins_ready = (sim_pin_level[SDA] = HIGH, sim_pin_level[SCL] = HIGH, true);
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t pin) { return sim_pin_level[pin]; }
+inline void digitalWrite(uint8_t pin, uint8_t level) {
+  if (pin != SDA && pin != SCL) sim_pin_level[pin] = level; // An idle bus stays released
+}
+
+inline char* dtostrf(double value, signed char width, unsigned char precision, char* buffer) {
+  sprintf(buffer, "%*.*f", width, precision, value);
+  return buffer;
+}
+
+// --- Print / Serial ---
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    for (size_t i = 0; i < size; i++) write(buffer[i]);
+    return size;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write((const uint8_t*)s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int n) { return printf_fmt("%d", n); }
+  size_t print(unsigned int n) { return printf_fmt("%u", n); }
+  size_t print(long n) { return printf_fmt("%ld", n); }
+  size_t print(unsigned long n) { return printf_fmt("%lu", n); }
+  size_t print(double n, int digits = 2) { return printf_fmt("%.*f", digits, n); }
+
+  size_t println() { return write((const uint8_t*)"\r\n", 2); }
+  template <typename T> size_t println(const T& value) { return print(value) + println(); }
+  size_t println(double n, int digits) { return print(n, digits) + println(); }
+
+private:
+  template <typename... Args> size_t printf_fmt(const char* fmt, Args... args) {
+    char buffer[32];
+    int length = snprintf(buffer, sizeof(buffer), fmt, args...);
+    return write((const uint8_t*)buffer, length);
+  }
+};
+
+// UART with a hardware TX FIFO: writes are free until the FIFO is full, then
+// block for as long as the bytes take to go out at the configured baud rate.
+class HardwareSerial : public Print {
+public:
+  static const size_t TX_FIFO_BYTES = 128;
+  uint64_t usPerByteX100 = 8681;  // 115200 baud, 10 bits per byte
+  uint64_t txBusyUntilUs = 0;
+  unsigned long bytesWritten = 0;
+  bool echo = false;              // Copy firmware logging to stdout
+
+  void begin(unsigned long baud) { usPerByteX100 = 1000000000ULL / baud; }
+
+  using Print::write;
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buffer, size_t size) override {
+    bytesWritten += size;
+    if (echo) fwrite(buffer, 1, size, stdout);
+    txBusyUntilUs = std::max(txBusyUntilUs, sim_micros) + size * usPerByteX100 / 100;
+    uint64_t fifoSpanUs = TX_FIFO_BYTES * usPerByteX100 / 100;
+    if (txBusyUntilUs > sim_micros + fifoSpanUs) {
+      sim_micros = txBusyUntilUs - fifoSpanUs;
+    }
+    return size;
+  }
+};
+
+inline HardwareSerial Serial;
+
+// --- Heap ---
+// Bytes the firmware itself has live on the heap; maintained by the operator
+// new/delete hooks in the test harness, which only count allocations made
+// while sim_heap_device is set.
+inline bool sim_heap_device = false;
+inline size_t sim_heap_live = 0;
+inline size_t sim_heap_peak = 0;
+inline const size_t SIM_HEAP_SIZE = 320 * 1024; // Typical free heap on the C6 before the sketch starts
+
+class EspClass {
+public:
+  uint32_t getFreeHeap() { return SIM_HEAP_SIZE - sim_heap_live; }
+  uint32_t getMinFreeHeap() { return SIM_HEAP_SIZE - sim_heap_peak; }
+};
+
+inline EspClass ESP;
+
+// --- Network Client Base ---
+class Client {
+public:
+  virtual ~Client() {}
+};
+
+#endif // SIM_ARDUINO_H
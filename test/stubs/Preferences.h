@@ -0,0 +1,52 @@
+// Host stand-in for ESP32 NVS. sim_nvs outlives the Preferences objects, so a
+// test can inspect it or clear it to simulate a factory-fresh device.
+
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+inline std::map<std::string, std::vector<uint8_t>> sim_nvs; // "namespace/key" -> value
+inline unsigned long sim_nvs_writes = 0;
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false) {
+    space = name;
+    this->readOnly = readOnly;
+    return true;
+  }
+  void end() { space.clear(); }
+
+  size_t putBytes(const char* key, const void* value, size_t length) {
+    if (readOnly) return 0;
+    const uint8_t* bytes = (const uint8_t*)value;
+    sim_nvs[space + "/" + key].assign(bytes, bytes + length);
+    sim_nvs_writes++;
+    return length;
+  }
+  size_t getBytes(const char* key, void* buffer, size_t maxLength) {
+    auto it = sim_nvs.find(space + "/" + key);
+    if (it == sim_nvs.end() || it->second.size() > maxLength) return 0;
+    memcpy(buffer, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+  size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0) {
+    uint32_t value;
+    return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+  }
+  bool remove(const char* key) {
+    if (readOnly) return false;
+    return sim_nvs.erase(space + "/" + key) > 0;
+  }
+
+private:
+  std::string space;
+  bool readOnly = false;
+};
+
+#endif // SIM_PREFERENCES_H
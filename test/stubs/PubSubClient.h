@@ -0,0 +1,134 @@
+// Host stand-in for knolleary/PubSubClient, connected to sim_broker.
+//
+// Keeps the behaviour the firmware depends on: one inbound packet per loop(),
+// publish() refusing packets that don't fit the buffer, inbound packets
+// larger than the buffer silently dropped, and the callback receiving
+// pointers into the shared buffer laid out exactly as the real library
+// leaves them. A guard byte after the buffer catches writes past its end.
+
+#ifndef SIM_PUBSUBCLIENT_H
+#define SIM_PUBSUBCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include "sim_broker.h"
+
+#define MQTT_MAX_PACKET_SIZE 256
+#define MQTT_MAX_HEADER_SIZE 5
+
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char*, uint8_t*, unsigned int)> callback
+
+inline unsigned long sim_mqtt_overruns = 0;      // Callback wrote past the end of the buffer
+inline unsigned long sim_mqtt_oversized_in = 0;  // Inbound packets dropped for not fitting the buffer
+
+class PubSubClient {
+public:
+  static const uint8_t GUARD = 0xA5;
+
+  PubSubClient() { setBufferSize(MQTT_MAX_PACKET_SIZE); }
+  PubSubClient(Client&) { setBufferSize(MQTT_MAX_PACKET_SIZE); }
+  ~PubSubClient() { delete[] buffer; }
+
+  PubSubClient& setServer(const char*, uint16_t) { return *this; }
+  PubSubClient& setCallback(MQTT_CALLBACK_SIGNATURE) {
+    this->callback = callback;
+    return *this;
+  }
+
+  bool setBufferSize(uint16_t size) {
+    if (size == 0) return false;
+    uint8_t* resized = new uint8_t[size + 1];
+    delete[] buffer;
+    buffer = resized;
+    bufferSize = size;
+    buffer[bufferSize] = GUARD;
+    return true;
+  }
+  uint16_t getBufferSize() { return bufferSize; }
+
+  bool connect(const char* id, const char*, const char*, const char* willTopic, uint8_t, bool willRetain,
+               const char* willMessage) {
+    sim_advance_us(2 * sim_broker.hopLatencyUs); // CONNECT / CONNACK round trip
+    clientId = id;
+    if (!sim_broker.connect(clientId, willTopic, willMessage, willRetain)) {
+      rc = MQTT_CONNECT_FAILED;
+      return false;
+    }
+    rc = MQTT_CONNECTED;
+    return true;
+  }
+
+  bool connected() {
+    if (rc == MQTT_CONNECTED && !sim_broker.connected(clientId)) {
+      rc = MQTT_CONNECTION_LOST;
+    }
+    return rc == MQTT_CONNECTED;
+  }
+
+  void disconnect() {
+    sim_broker.disconnect(clientId);
+    rc = MQTT_DISCONNECTED;
+  }
+
+  int state() { return rc; }
+
+  bool publish(const char* topic, const char* payload) { return publish(topic, payload, false); }
+  bool publish(const char* topic, const char* payload, bool retained) {
+    size_t length = payload ? strlen(payload) : 0;
+    if (!connected()) return false;
+    if (bufferSize < MQTT_MAX_HEADER_SIZE + 2 + strnlen(topic, bufferSize) + length) return false;
+    return sim_broker.publish(clientId, topic, std::string(payload ? payload : "", length), retained);
+  }
+
+  bool subscribe(const char* topic) { return connected() && sim_broker.subscribe(clientId, topic); }
+  bool unsubscribe(const char* topic) { return connected() && sim_broker.unsubscribe(clientId, topic); }
+
+  bool loop() {
+    if (!connected()) return false;
+    SimMessage message;
+    if (!sim_broker.receive(clientId, message)) return true;
+
+    // PUBLISH packet: fixed header, remaining length, topic length, topic, payload
+    size_t remaining = 2 + message.topic.size() + message.payload.size();
+    size_t llen = remaining < 128 ? 1 : remaining < 16384 ? 2 : 3;
+    size_t len = 1 + llen + remaining;
+    if (len > bufferSize) {
+      sim_mqtt_oversized_in++; // The real library reads and discards it
+      return true;
+    }
+
+    size_t tl = message.topic.size();
+    buffer[0] = message.retained ? 0x31 : 0x30;
+    buffer[llen + 1] = tl >> 8;
+    buffer[llen + 2] = tl & 0xFF;
+    memcpy(buffer + llen + 3, message.topic.data(), tl);
+    memcpy(buffer + llen + 3 + tl, message.payload.data(), message.payload.size());
+
+    // Same in-place shuffle as PubSubClient::loop(), which NUL-terminates the topic
+    memmove(buffer + llen + 2, buffer + llen + 3, tl);
+    buffer[llen + 2 + tl] = 0;
+    if (callback) {
+      callback((char*)buffer + llen + 2, buffer + llen + 3 + tl, len - llen - 3 - tl);
+    }
+
+    if (buffer[bufferSize] != GUARD) {
+      sim_mqtt_overruns++;
+      buffer[bufferSize] = GUARD;
+    }
+    return true;
+  }
+
+private:
+  MQTT_CALLBACK_SIGNATURE;
+  uint8_t* buffer = nullptr;
+  uint16_t bufferSize = 0;
+  std::string clientId;
+  int rc = MQTT_DISCONNECTED;
+};
+
+#endif // SIM_PUBSUBCLIENT_H
@@ -0,0 +1,10 @@
+// light_controller.h includes <String.h>. On a case-insensitive file system
+// this file is also what <string.h> resolves to, so pull the C header in too.
+
+#ifndef SIM_STRING_H
+#define SIM_STRING_H
+
+#include_next <string.h>
+#include "WString.h"
+
+#endif // SIM_STRING_H
@@ -0,0 +1,90 @@
+// Host stand-in for the Arduino String class, backed by std::string. Also the
+// ::String that ArduinoJson binds to when ARDUINOJSON_ENABLE_ARDUINO_STRING=1.
+
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <string>
+
+class String {
+public:
+  String() {}
+  String(const char* s) { if (s) value = s; }
+  String(const String& s) = default;
+  String(char c) : value(1, c) {}
+  String(int n) : value(std::to_string(n)) {}
+  String(unsigned int n) : value(std::to_string(n)) {}
+  String(long n) : value(std::to_string(n)) {}
+  String(unsigned long n) : value(std::to_string(n)) {}
+  String(float n, unsigned int decimals = 2) : value(format(n, decimals)) {}
+  String(double n, unsigned int decimals = 2) : value(format(n, decimals)) {}
+
+  String& operator=(const String& s) = default;
+  String& operator=(const char* s) {
+    if (s) value = s; else value.clear();
+    return *this;
+  }
+
+  const char* c_str() const { return value.c_str(); }
+  unsigned int length() const { return value.length(); }
+
+  bool concat(const String& s) { value += s.value; return true; }
+  bool concat(const char* s) { if (!s) return false; value += s; return true; }
+  bool concat(char c) { value += c; return true; }
+  String& operator+=(const String& s) { concat(s); return *this; }
+  String& operator+=(const char* s) { concat(s); return *this; }
+  String& operator+=(char c) { concat(c); return *this; }
+
+  bool equals(const String& s) const { return value == s.value; }
+  bool equals(const char* s) const { return s && value == s; }
+  bool operator==(const String& s) const { return equals(s); }
+  bool operator==(const char* s) const { return equals(s); }
+  bool operator!=(const String& s) const { return !equals(s); }
+  bool operator!=(const char* s) const { return !equals(s); }
+
+  int indexOf(char c) const {
+    size_t at = value.find(c);
+    return at == std::string::npos ? -1 : (int)at;
+  }
+  String substring(unsigned int from) const { return substring(from, length()); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= length()) return String();
+    return String(value.substr(from, to - from).c_str());
+  }
+
+  void toUpperCase() { for (char& c : value) c = toupper((unsigned char)c); }
+  long toInt() const { return atol(value.c_str()); }
+  float toFloat() const { return atof(value.c_str()); }
+
+private:
+  static std::string format(double n, unsigned int decimals) {
+    char buffer[40];
+    snprintf(buffer, sizeof(buffer), "%.*f", (int)decimals, n);
+    return buffer;
+  }
+
+  std::string value;
+};
+
+class StringSumHelper : public String {
+public:
+  StringSumHelper(const String& s) : String(s) {}
+};
+
+inline StringSumHelper operator+(const StringSumHelper& lhs, const String& rhs) {
+  StringSumHelper sum(lhs);
+  sum.concat(rhs);
+  return sum;
+}
+
+inline StringSumHelper operator+(const StringSumHelper& lhs, const char* rhs) {
+  StringSumHelper sum(lhs);
+  sum.concat(rhs);
+  return sum;
+}
+
+#endif // SIM_WSTRING_H
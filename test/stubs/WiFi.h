@@ -0,0 +1,78 @@
+// Host stand-in for the ESP32 WiFi library. The station associates
+// sim_wifi.associateMs after begin(), and the harness can drop the link.
+
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#include <Arduino.h>
+
+#define WL_IDLE_STATUS 0
+#define WL_DISCONNECTED 6
+#define WL_CONNECTED 3
+#define WIFI_STA 1
+
+class IPAddress {
+public:
+  IPAddress() {}
+  IPAddress(uint32_t address) : address(address) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  operator uint32_t() const { return address; }
+  bool fromString(const char* s) {
+    unsigned int a, b, c, d;
+    if (sscanf(s, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false;
+    *this = IPAddress(a, b, c, d);
+    return true;
+  }
+
+private:
+  uint32_t address = 0;
+};
+
+struct SimWifi {
+  unsigned long associateMs = 300; // Scan + association + DHCP
+  bool apUp = true;
+  bool begun = false;
+  uint64_t connectAtUs = 0;
+  unsigned long begins = 0;
+};
+
+inline SimWifi sim_wifi;
+
+class WiFiClass {
+public:
+  void setHostname(const char*) {}
+  void persistent(bool) {}
+  bool mode(int) { return true; }
+  bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress()) { return true; }
+  int begin(const char*, const char*, int32_t = 0, const uint8_t* = nullptr, bool = true) {
+    sim_wifi.begun = true;
+    sim_wifi.begins++;
+    sim_wifi.connectAtUs = sim_micros + (uint64_t)sim_wifi.associateMs * 1000;
+    return status();
+  }
+  bool disconnect(bool = false, bool = false) {
+    sim_wifi.begun = false;
+    return true;
+  }
+  int status() {
+    bool up = sim_wifi.begun && sim_wifi.apUp && sim_micros >= sim_wifi.connectAtUs;
+    return up ? WL_CONNECTED : WL_DISCONNECTED;
+  }
+
+  int32_t channel() { return 6; }
+  uint8_t* BSSID() { return bssid; }
+  IPAddress localIP() { return IPAddress(192, 168, 0, 80); }
+  IPAddress gatewayIP() { return IPAddress(192, 168, 0, 1); }
+  IPAddress subnetMask() { return IPAddress(255, 255, 255, 0); }
+  IPAddress dnsIP(uint8_t = 0) { return IPAddress(192, 168, 0, 1); }
+
+private:
+  uint8_t bssid[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+};
+
+inline WiFiClass WiFi;
+
+class WiFiClient : public Client {};
+
+#endif // SIM_WIFI_H
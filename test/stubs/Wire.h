@@ -0,0 +1,25 @@
+// Host stand-in for the ESP32 Wire library: an idle bus with nothing on it.
+// Every address NACKs, so the sensor supervisor keeps all three devices
+// offline and their re-probes cost nothing.
+
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  bool begin() { return true; }
+  bool end() { return true; }
+  void setTimeOut(uint16_t) {}
+  void beginTransmission(uint8_t) {}
+  size_t write(uint8_t) { return 1; }
+  uint8_t endTransmission(bool = true) { return 2; } // Address NACK
+  uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+  int available() { return 0; }
+  int read() { return -1; }
+};
+
+inline TwoWire Wire;
+
+#endif // SIM_WIRE_H
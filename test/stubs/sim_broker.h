@@ -0,0 +1,236 @@
+// In-process MQTT broker for the host load tests.
+//
+// Models what matters to the firmware under load: retained messages, QoS 0
+// routing with a per-hop latency, per-session queues with mosquitto's
+// drop-when-full behaviour, last wills, and scripted connection faults.
+// The device's PubSubClient stand-in and the test's SimPeer clients both
+// talk to sim_broker directly.
+
+#ifndef SIM_BROKER_H
+#define SIM_BROKER_H
+
+#include <Arduino.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+struct SimMessage {
+  std::string topic;
+  std::string payload;
+  bool retained;
+  uint64_t deliverAtUs;
+};
+
+struct SimSession {
+  bool connected = false;
+  std::set<std::string> subscriptions;
+  std::deque<SimMessage> inbox;
+  size_t inboxBytes = 0;
+  unsigned long dropped = 0;   // Discarded because the inbox was full
+  std::string willTopic;
+  std::string willPayload;
+  bool willRetain = false;
+};
+
+// Broker-side work must not be charged to the firmware's heap
+struct SimHeapOutside {
+  bool saved;
+  SimHeapOutside() : saved(sim_heap_device) { sim_heap_device = false; }
+  ~SimHeapOutside() { sim_heap_device = saved; }
+};
+
+class SimBroker {
+public:
+  // --- Tuning ---
+  bool online = true;
+  uint64_t hopLatencyUs = 1000;   // Client <-> broker, one way
+  size_t maxQueuedMessages = 1000; // Per session, like mosquitto's max_queued_messages
+
+  // --- Scripted Faults ---
+  // The next publish on this topic tears the connection down. If the sender
+  // "wrote" it first, it believes the publish succeeded (QoS 0 over a socket
+  // that died before the broker read it); otherwise its write fails.
+  std::string dropOnPublishTopic;
+  bool dropAfterWrite = false;
+
+  // --- Statistics ---
+  std::map<std::string, unsigned long> publishCount; // By topic, as received
+  unsigned long routed = 0;
+  size_t queuedBytesPeak = 0;
+
+  // Returns false if the broker is refusing connections
+  bool connect(const std::string& id, const char* willTopic = nullptr, const char* willPayload = nullptr,
+               bool willRetain = false) {
+    SimHeapOutside outside;
+    if (!online) return false;
+    SimSession& s = sessions[id];
+    if (s.connected) drop(id); // Session takeover
+    s = SimSession();
+    s.connected = true;
+    if (willTopic) {
+      s.willTopic = willTopic;
+      s.willPayload = willPayload ? willPayload : "";
+      s.willRetain = willRetain;
+    }
+    return true;
+  }
+
+  bool connected(const std::string& id) const {
+    auto it = sessions.find(id);
+    return it != sessions.end() && it->second.connected;
+  }
+
+  void disconnect(const std::string& id) {
+    SimHeapOutside outside;
+    auto it = sessions.find(id);
+    if (it == sessions.end()) return;
+    it->second.connected = false;
+    it->second.inbox.clear();
+    it->second.inboxBytes = 0;
+  }
+
+  // Ungraceful loss of the connection: the broker publishes the session's will
+  void drop(const std::string& id) {
+    SimHeapOutside outside;
+    auto it = sessions.find(id);
+    if (it == sessions.end() || !it->second.connected) return;
+    SimSession s = it->second;
+    disconnect(id);
+    if (!s.willTopic.empty()) route(s.willTopic, s.willPayload, s.willRetain);
+  }
+
+  // Returns what the sender's socket write would return
+  bool publish(const std::string& id, const std::string& topic, const std::string& payload, bool retain) {
+    SimHeapOutside outside;
+    if (!connected(id)) return false;
+    if (!dropOnPublishTopic.empty() && topic == dropOnPublishTopic) {
+      dropOnPublishTopic.clear();
+      drop(id);
+      return dropAfterWrite;
+    }
+    publishCount[topic]++;
+    route(topic, payload, retain);
+    return true;
+  }
+
+  bool subscribe(const std::string& id, const std::string& filter) {
+    SimHeapOutside outside;
+    if (!connected(id)) return false;
+    SimSession& s = sessions[id];
+    s.subscriptions.insert(filter);
+    for (const auto& entry : retained) {
+      if (matches(filter, entry.first)) enqueue(s, entry.first, entry.second, true);
+    }
+    return true;
+  }
+
+  bool unsubscribe(const std::string& id, const std::string& filter) {
+    SimHeapOutside outside;
+    if (!connected(id)) return false;
+    sessions[id].subscriptions.erase(filter);
+    return true;
+  }
+
+  // Pops the session's next message once its delivery time has come
+  bool receive(const std::string& id, SimMessage& message) {
+    SimHeapOutside outside;
+    auto it = sessions.find(id);
+    if (it == sessions.end() || !it->second.connected) return false;
+    SimSession& s = it->second;
+    if (s.inbox.empty() || s.inbox.front().deliverAtUs > sim_micros) return false;
+    message = s.inbox.front();
+    s.inbox.pop_front();
+    s.inboxBytes -= message.topic.size() + message.payload.size();
+    return true;
+  }
+
+  const SimSession& session(const std::string& id) { return sessions[id]; }
+
+  // The retained copy of a topic, empty if none
+  std::string retainedPayload(const std::string& topic) const {
+    auto it = retained.find(topic);
+    return it == retained.end() ? std::string() : it->second;
+  }
+
+  void reset() {
+    SimHeapOutside outside;
+    *this = SimBroker();
+  }
+
+private:
+  static bool matches(const std::string& filter, const std::string& topic) {
+    size_t f = 0, t = 0;
+    while (f < filter.size()) {
+      if (filter[f] == '#') return true;
+      if (filter[f] == '+') {
+        while (t < topic.size() && topic[t] != '/') t++;
+        f++;
+        continue;
+      }
+      if (t >= topic.size() || filter[f] != topic[t]) return false;
+      f++;
+      t++;
+    }
+    return t == topic.size();
+  }
+
+  void route(const std::string& topic, const std::string& payload, bool retain) {
+    if (retain) {
+      if (payload.empty()) retained.erase(topic);
+      else retained[topic] = payload;
+    }
+    for (auto& entry : sessions) {
+      SimSession& s = entry.second;
+      if (!s.connected) continue;
+      for (const std::string& filter : s.subscriptions) {
+        if (matches(filter, topic)) {
+          enqueue(s, topic, payload, false);
+          break;
+        }
+      }
+    }
+  }
+
+  void enqueue(SimSession& s, const std::string& topic, const std::string& payload, bool retain) {
+    if (s.inbox.size() >= maxQueuedMessages) {
+      s.dropped++;
+      return;
+    }
+    // Sender to broker, then broker to receiver
+    s.inbox.push_back({ topic, payload, retain, sim_micros + 2 * hopLatencyUs });
+    s.inboxBytes += topic.size() + payload.size();
+    routed++;
+
+    size_t queued = 0;
+    for (const auto& entry : sessions) queued += entry.second.inboxBytes;
+    queuedBytesPeak = std::max(queuedBytesPeak, queued);
+  }
+
+  std::map<std::string, SimSession> sessions;
+  std::map<std::string, std::string> retained;
+};
+
+inline SimBroker sim_broker;
+
+// --- Test-Side Client ---
+// A peer such as Home Assistant or a load generator, talking to the broker
+// without going through PubSubClient.
+class SimPeer {
+public:
+  explicit SimPeer(const std::string& id) : id(id) {}
+
+  bool connect() { return sim_broker.connect(id); }
+  void disconnect() { sim_broker.disconnect(id); }
+  bool subscribe(const std::string& filter) { return sim_broker.subscribe(id, filter); }
+  bool publish(const std::string& topic, const std::string& payload, bool retain = false) {
+    return sim_broker.publish(id, topic, payload, retain);
+  }
+  bool receive(SimMessage& message) { return sim_broker.receive(id, message); }
+  const SimSession& session() { return sim_broker.session(id); }
+
+  const std::string id;
+};
+
+#endif // SIM_BROKER_H
@@ -0,0 +1,409 @@
+// Host load tests for the MQTT command path. The real firmware (setup(),
+// loop(), connections.cpp, discovery.cpp and the command handlers) runs
+// against the stand-ins in test/stubs and an in-process broker, on a
+// simulated clock, through scripted scenarios:
+//
+//   - broker connection lost during mqtt_discovery(), at boot and on rediscovery
+//   - command floods on the /command topics
+//   - a slow consumer subscribed to everything the hub publishes
+//   - oversized payloads on the /command topics
+//
+// Each scenario prints throughput, command-to-relay latency percentiles and
+// heap high-water marks, and fails on lost commands, buffer overruns, leaks
+// or latency past its budget. Latency is measured the way a real sender
+// would: a token on the light command, timed until the hub echoes it on
+// MQTT_TOPIC_LIGHT_ACK.
+//
+//   pio test -e native_mqtt -v
+
+#include <unity.h>
+#include <stddef.h>
+#include <new>
+#include <map>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include "config.h"
+#include "boot_cache.h"
+
+// --- Firmware Under Test ---
+void setup();  // main.cpp
+void loop();
+extern PubSubClient client;            // main.cpp
+extern unsigned long messagesRejected; // net_metrics.cpp
+
+// --- Heap Accounting ---
+// Every allocation carries its size and whether the firmware made it, so the
+// hub's own live heap and high-water mark can be told apart from the harness.
+struct AllocationHeader {
+  size_t size;
+  bool device;
+  alignas(max_align_t) char payload[1];
+};
+const size_t ALLOCATION_OFFSET = offsetof(AllocationHeader, payload);
+
+void* tracked_alloc(size_t size) {
+  AllocationHeader* header = (AllocationHeader*)malloc(ALLOCATION_OFFSET + size);
+  if (header == nullptr) return nullptr;
+  header->size = size;
+  header->device = sim_heap_device;
+  if (header->device) {
+    sim_heap_live += size;
+    sim_heap_peak = std::max(sim_heap_peak, sim_heap_live);
+  }
+  return header->payload;
+}
+
+void tracked_free(void* p) {
+  if (p == nullptr) return;
+  AllocationHeader* header = (AllocationHeader*)((char*)p - ALLOCATION_OFFSET);
+  if (header->device) sim_heap_live -= header->size;
+  free(header);
+}
+
+void* operator new(size_t size) {
+  void* p = tracked_alloc(size);
+  if (p == nullptr) throw std::bad_alloc();
+  return p;
+}
+void* operator new[](size_t size) { return operator new(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return tracked_alloc(size); }
+void operator delete(void* p) noexcept { tracked_free(p); }
+void operator delete[](void* p) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t) noexcept { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
+
+// --- Simulation ---
+// Cost of one loop() pass beyond what the stubs charge themselves (Serial,
+// connect); the I2C reads it stands for are offline on the simulated bus.
+const uint64_t LOOP_COST_US = 1000;
+
+// The command path itself only allocates short Strings; this leaves room for
+// a periodic JSON diagnostics publish landing inside a scenario.
+const size_t HEAP_GROWTH_BUDGET = 16 * 1024;
+
+struct DeviceScope {
+  DeviceScope() { sim_heap_device = true; }
+  ~DeviceScope() { sim_heap_device = false; }
+};
+
+void device_loop() {
+  {
+    DeviceScope device;
+    loop();
+  }
+  sim_advance_us(LOOP_COST_US);
+}
+
+template <typename Done>
+bool run_until(Done done, uint64_t timeoutUs) {
+  uint64_t deadline = sim_micros + timeoutUs;
+  while (!done()) {
+    if (sim_micros >= deadline) return false;
+    device_loop();
+  }
+  return true;
+}
+
+void run_for(uint64_t us) {
+  uint64_t end = sim_micros + us;
+  while (sim_micros < end) device_loop();
+}
+
+bool discovery_confirmed() {
+  std::string retained = sim_broker.retainedPayload(MQTT_TOPIC_DEVICE_DISCOVERY);
+  return !retained.empty() && load_discovery_hash() == fnv1a_hash(retained.data(), retained.size());
+}
+
+// --- Sender-Side Latency Measurement ---
+// Sends tokened light commands and times each one until its ack arrives.
+struct LatencyProbe {
+  SimPeer peer;
+  std::map<unsigned long, uint64_t> sentAt;
+  std::map<unsigned long, std::string> expectedState;
+  std::vector<uint64_t> latenciesUs;
+  unsigned long nextToken = 1;
+  unsigned long sent = 0;
+  unsigned long wrongState = 0;
+
+  explicit LatencyProbe(const char* id) : peer(id) {
+    peer.connect();
+    peer.subscribe(MQTT_TOPIC_LIGHT_ACK);
+  }
+
+  void send(bool on) {
+    unsigned long token = nextToken++;
+    std::string payload = std::string(on ? "ON#" : "OFF#") + std::to_string(token);
+    sentAt[token] = sim_micros;
+    expectedState[token] = on ? MQTT_PAYLOAD_ON : MQTT_PAYLOAD_OFF;
+    sent++;
+    peer.publish(MQTT_TOPIC_LIGHT_COMMAND, payload);
+  }
+
+  void collect() {
+    SimMessage ack;
+    while (peer.receive(ack)) {
+      unsigned long token = strtoul(ack.payload.c_str(), nullptr, 10);
+      auto it = sentAt.find(token);
+      if (it == sentAt.end()) continue;
+      latenciesUs.push_back(ack.deliverAtUs - it->second);
+      if (ack.payload.substr(ack.payload.find(' ') + 1) != expectedState[token]) wrongState++;
+      sentAt.erase(it);
+    }
+  }
+
+  bool all_acked() const { return sentAt.empty(); }
+};
+
+// --- Reporting ---
+struct Scenario {
+  const char* name;
+  uint64_t startUs;
+  size_t heapBase;
+  unsigned long brokerRouted;
+
+  explicit Scenario(const char* name) : name(name) {
+    startUs = sim_micros;
+    heapBase = sim_heap_live;
+    sim_heap_peak = sim_heap_live; // Re-arm the high-water mark
+    sim_broker.queuedBytesPeak = 0;
+    brokerRouted = sim_broker.routed;
+  }
+
+  size_t heap_peak_growth() const { return sim_heap_peak - heapBase; }
+  long heap_leak() const { return (long)sim_heap_live - (long)heapBase; }
+};
+
+// Nearest-rank, as in net_metrics.cpp
+double percentile_ms(std::vector<uint64_t> sorted, int pct) {
+  if (sorted.empty()) return 0.0;
+  std::sort(sorted.begin(), sorted.end());
+  size_t rank = (pct * sorted.size() + 99) / 100;
+  return sorted[std::max(rank, (size_t)1) - 1] / 1000.0;
+}
+
+void report(const Scenario& scenario, const LatencyProbe* probe) {
+  double seconds = (sim_micros - scenario.startUs) / 1e6;
+  printf("\n--- %s ---\n", scenario.name);
+  printf("  simulated time       %10.3f s\n", seconds);
+  printf("  broker deliveries    %10lu (%.0f msg/s)\n", sim_broker.routed - scenario.brokerRouted,
+         (sim_broker.routed - scenario.brokerRouted) / seconds);
+  if (probe != nullptr) {
+    printf("  light commands       %10lu sent, %lu acked, %lu wrong state\n", probe->sent,
+           (unsigned long)probe->latenciesUs.size(), probe->wrongState);
+    printf("  command throughput   %10.1f cmd/s\n", probe->latenciesUs.size() / seconds);
+    printf("  command-to-relay     p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+           percentile_ms(probe->latenciesUs, 50), percentile_ms(probe->latenciesUs, 95),
+           percentile_ms(probe->latenciesUs, 99), percentile_ms(probe->latenciesUs, 100));
+  }
+  printf("  device heap          %10zu B live, peak +%zu B (min free %u B)\n", sim_heap_live,
+         scenario.heap_peak_growth(), ESP.getMinFreeHeap());
+  printf("  broker queue peak    %10zu B\n", sim_broker.queuedBytesPeak);
+  printf("  rejected / overruns  %10lu / %lu\n", messagesRejected, sim_mqtt_overruns);
+}
+
+// --- Scenarios ---
+
+void setUp() {}
+void tearDown() {}
+
+// First boot: the connection dies while the discovery document is in flight,
+// after PubSubClient has already handed it to the socket.
+void test_boot_with_disconnect_during_discovery() {
+  Scenario scenario("boot, connection lost mid-discovery");
+  sim_broker.dropOnPublishTopic = MQTT_TOPIC_DEVICE_DISCOVERY;
+  sim_broker.dropAfterWrite = true;
+
+  {
+    DeviceScope device;
+    setup();
+  }
+  TEST_ASSERT_TRUE(run_until([] { return client.connected(); }, 5000000));
+  TEST_ASSERT_TRUE(run_until([] { return !client.connected(); }, 5000000));
+
+  // The publish "succeeded" but the broker never stored it: nothing may be cached
+  TEST_ASSERT_EQUAL_UINT32(0, load_discovery_hash());
+  TEST_ASSERT_TRUE(sim_broker.retainedPayload(MQTT_TOPIC_DEVICE_DISCOVERY).empty());
+  TEST_ASSERT_EQUAL_STRING(MQTT_PAYLOAD_OFFLINE, sim_broker.retainedPayload(MQTT_TOPIC_DEVICE_AVAILABILITY).c_str());
+
+  TEST_ASSERT_TRUE(run_until(discovery_confirmed, 30000000));
+  TEST_ASSERT_EQUAL_STRING(MQTT_PAYLOAD_ONLINE, sim_broker.retainedPayload(MQTT_TOPIC_DEVICE_AVAILABILITY).c_str());
+  TEST_ASSERT_EQUAL_UINT32(1, sim_broker.publishCount[MQTT_TOPIC_DEVICE_DISCOVERY]);
+  report(scenario, nullptr);
+}
+
+// Home Assistant restarts and asks for discovery; the broker drops the hub
+// while it writes the document. It must reconnect and resend, without a
+// second copy once the broker holds it.
+void test_rediscovery_with_disconnect_during_discovery() {
+  Scenario scenario("rediscovery, connection lost mid-discovery");
+  SimPeer homeAssistant("home_assistant");
+  homeAssistant.connect();
+  unsigned long published = sim_broker.publishCount[MQTT_TOPIC_DEVICE_DISCOVERY];
+
+  sim_broker.dropOnPublishTopic = MQTT_TOPIC_DEVICE_DISCOVERY;
+  sim_broker.dropAfterWrite = false;
+  homeAssistant.publish(MQTT_TOPIC_HA_STATUS, MQTT_PAYLOAD_ONLINE);
+
+  TEST_ASSERT_TRUE(run_until([] { return !client.connected(); }, 1000000));
+  TEST_ASSERT_TRUE(run_until([&] { return sim_broker.publishCount[MQTT_TOPIC_DEVICE_DISCOVERY] > published; }, 30000000));
+  TEST_ASSERT_TRUE(run_until(discovery_confirmed, 1000000));
+
+  // A later reconnect must not republish an unchanged, confirmed document
+  sim_broker.drop(DEVICE_ID);
+  TEST_ASSERT_TRUE(run_until([] { return client.connected(); }, 10000000));
+  run_for(1000000);
+  TEST_ASSERT_EQUAL_UINT32(published + 1, sim_broker.publishCount[MQTT_TOPIC_DEVICE_DISCOVERY]);
+  report(scenario, nullptr);
+
+  homeAssistant.disconnect();
+}
+
+// 500 light commands back to back, every fifth one interleaved with another
+// /command topic, far faster than the hub can drain them.
+void test_command_flood() {
+  Scenario scenario("command flood");
+  LatencyProbe probe("load_generator");
+  const unsigned long FLOOD_COMMANDS = 500;
+  const uint64_t SEND_INTERVAL_US = 100;
+
+  // Values equal to the current settings, so the flood doesn't change behaviour
+  std::string motionTimer = std::to_string(INITIAL_MOTION_TIMER_DURATION_MS / 1000);
+  std::string manualTimer = std::to_string(INITIAL_MANUAL_TIMER_DURATION_MS / 1000);
+  const std::pair<const char*, std::string> otherCommands[] = {
+    { MQTT_TOPIC_MOTION_TIMER_COMMAND, motionTimer },
+    { MQTT_TOPIC_MANUAL_TIMER_COMMAND, manualTimer },
+    { MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND, "5" },
+    { MQTT_TOPIC_PRESSURE_SAMPLE_MAX_COMMAND, "600" },
+    { MQTT_TOPIC_LUX_SAMPLE_MIN_COMMAND, "1" },
+  };
+
+  uint64_t nextSend = sim_micros;
+  unsigned long other = 0;
+  bool drained = run_until([&] {
+    while (probe.sent < FLOOD_COMMANDS && sim_micros >= nextSend) {
+      probe.send(probe.sent % 2 == 0); // Alternate ON and OFF, ending OFF
+      if (probe.sent % 5 == 0) {
+        const auto& command = otherCommands[other++ % 5];
+        probe.peer.publish(command.first, command.second);
+      }
+      nextSend += SEND_INTERVAL_US;
+    }
+    probe.collect();
+    return probe.sent == FLOOD_COMMANDS && probe.all_acked();
+  }, 60000000);
+  report(scenario, &probe);
+
+  TEST_ASSERT_TRUE_MESSAGE(drained, "light commands lost or never acknowledged");
+  TEST_ASSERT_EQUAL_UINT32(0, probe.wrongState);
+  TEST_ASSERT_EQUAL(LOW, sim_pin_level[LIGHT_RELAY_PIN]);
+  TEST_ASSERT_EQUAL_UINT32(0, probe.peer.session().dropped);
+  TEST_ASSERT_EQUAL_UINT32(0, sim_broker.session(DEVICE_ID).dropped);
+  TEST_ASSERT_EQUAL_UINT32(0, sim_mqtt_overruns);
+
+  // Drain rate is bound by Serial logging at 115200 baud (about 110 bytes per
+  // light command); dropping below this means the command path got heavier
+  TEST_ASSERT_TRUE(probe.latenciesUs.size() / ((sim_micros - scenario.startUs) / 1e6) >= 50.0);
+
+  // The hub drains one message per loop() pass; a flood only queues at the broker
+  TEST_ASSERT_TRUE(scenario.heap_peak_growth() < HEAP_GROWTH_BUDGET);
+  TEST_ASSERT_TRUE(scenario.heap_leak() <= 0);
+  probe.peer.disconnect();
+}
+
+// A dashboard subscribed to everything drains one message every 50 ms while
+// the broker only queues 50 per client. Its backlog must be dropped at the
+// broker without slowing the hub or other clients.
+void test_slow_consumer() {
+  Scenario scenario("slow consumer");
+  sim_broker.maxQueuedMessages = 50;
+  SimPeer dashboard("dashboard");
+  dashboard.connect();
+  dashboard.subscribe("home/shed/#");
+  dashboard.subscribe("devices/#");
+  LatencyProbe probe("automation");
+  const unsigned long COMMANDS = 200;
+  const uint64_t SEND_INTERVAL_US = 50000;
+  const uint64_t DRAIN_INTERVAL_US = 50000;
+
+  uint64_t nextSend = sim_micros;
+  uint64_t nextDrain = sim_micros;
+  bool drained = run_until([&] {
+    if (probe.sent < COMMANDS && sim_micros >= nextSend) {
+      probe.send(probe.sent % 2 == 0);
+      nextSend += SEND_INTERVAL_US;
+    }
+    if (sim_micros >= nextDrain) {
+      SimMessage message;
+      dashboard.receive(message);
+      nextDrain += DRAIN_INTERVAL_US;
+    }
+    probe.collect();
+    return probe.sent == COMMANDS && probe.all_acked();
+  }, 60000000);
+  report(scenario, &probe);
+  printf("  dashboard dropped    %10lu\n", dashboard.session().dropped);
+
+  TEST_ASSERT_TRUE_MESSAGE(drained, "light commands lost or never acknowledged");
+  TEST_ASSERT_TRUE_MESSAGE(dashboard.session().dropped > 0, "slow consumer never backed up");
+  TEST_ASSERT_EQUAL_UINT32(0, probe.peer.session().dropped);
+  TEST_ASSERT_EQUAL_UINT32(0, sim_broker.session(DEVICE_ID).dropped);
+
+  // Well under the hub's drain rate, each command is handled on arrival
+  TEST_ASSERT_TRUE(percentile_ms(probe.latenciesUs, 99) < 50.0);
+  TEST_ASSERT_TRUE(scenario.heap_peak_growth() < HEAP_GROWTH_BUDGET);
+  TEST_ASSERT_TRUE(scenario.heap_leak() <= 0);
+
+  dashboard.disconnect();
+  probe.peer.disconnect();
+  sim_broker.maxQueuedMessages = SimBroker().maxQueuedMessages;
+}
+
+// Payloads just over the command limit, well over it, exactly filling the
+// PubSubClient buffer, and one byte too large for it.
+void test_oversized_payloads() {
+  Scenario scenario("oversized payloads");
+  LatencyProbe probe("fuzzer");
+  unsigned long rejectedBefore = messagesRejected;
+  unsigned long oversizedBefore = sim_mqtt_oversized_in;
+
+  // PUBLISH framing around the payload once it needs a 2-byte remaining length
+  size_t framing = 1 + 2 + 2 + strlen(MQTT_TOPIC_LIGHT_COMMAND);
+  size_t fillsBuffer = client.getBufferSize() - framing;
+  const size_t sizes[] = { MQTT_MAX_COMMAND_PAYLOAD + 1, 1024, fillsBuffer, fillsBuffer + 1 };
+  for (size_t size : sizes) {
+    probe.peer.publish(MQTT_TOPIC_LIGHT_COMMAND, "ON" + std::string(size - 2, ' '));
+  }
+  probe.peer.publish(MQTT_TOPIC_CLIMATE_SAMPLE_MIN_COMMAND, std::string(64, '5'));
+  run_for(500000);
+
+  TEST_ASSERT_EQUAL_UINT32(0, sim_mqtt_overruns);
+  TEST_ASSERT_EQUAL_UINT32(4, messagesRejected - rejectedBefore);        // Reached the callback, dropped there
+  TEST_ASSERT_EQUAL_UINT32(1, sim_mqtt_oversized_in - oversizedBefore);  // Never fit the buffer
+  TEST_ASSERT_EQUAL(LOW, sim_pin_level[LIGHT_RELAY_PIN]);                // None of them acted on
+
+  // The command path still works afterwards
+  probe.send(true);
+  probe.send(false);
+  TEST_ASSERT_TRUE(run_until([&] { probe.collect(); return probe.all_acked(); }, 1000000));
+  report(scenario, &probe);
+
+  TEST_ASSERT_EQUAL_UINT32(0, probe.wrongState);
+  TEST_ASSERT_TRUE(scenario.heap_leak() <= 0);
+  probe.peer.disconnect();
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_boot_with_disconnect_during_discovery);
+  RUN_TEST(test_rediscovery_with_disconnect_during_discovery);
+  RUN_TEST(test_command_flood);
+  RUN_TEST(test_slow_consumer);
+  RUN_TEST(test_oversized_payloads);
+  return UNITY_END();
+}
@@ -0,0 +1,352 @@
+// Host tests for weather_math: dew point against a saturation-pressure
+// reference, heat index against the published NWS heat index chart, and
+// RollingWindow against a brute-force window over the raw samples.
+//
+//   pio test -e native
+
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+#include "weather_math.h"
+
+void setUp() {}
+void tearDown() {}
+
+// --- Reference Implementations ---
+
+// Magnus saturation vapour pressure (hPa), Sonntag constants
+double ref_saturation_hpa(double temperatureC) {
+  return 6.112 * exp(17.62 * temperatureC / (243.12 + temperatureC));
+}
+
+// NWS heat index chart (weather.gov/safety/heat-index), rounded to whole °F.
+// Cells where the chart and the high-humidity adjustment disagree are left out.
+struct HeatIndexCell {
+  float temperatureF;
+  float humidity;
+  float heatIndexF;
+};
+
+const HeatIndexCell NWS_HEAT_INDEX_CHART[] = {
+  { 80, 40, 80 }, { 80, 45, 80 }, { 80, 50, 81 }, { 80, 55, 81 }, { 80, 60, 82 },
+  { 80, 65, 82 }, { 80, 70, 83 }, { 80, 75, 84 }, { 80, 80, 84 }, { 80, 85, 85 },
+  { 84, 40, 83 }, { 84, 45, 84 }, { 84, 50, 85 }, { 84, 55, 86 }, { 84, 60, 88 },
+  { 84, 65, 89 }, { 84, 70, 90 }, { 84, 75, 92 }, { 84, 80, 94 }, { 84, 85, 96 },
+  { 90, 40, 91 }, { 90, 45, 93 }, { 90, 50, 95 }, { 90, 55, 97 }, { 90, 60, 100 },
+  { 90, 65, 103 }, { 90, 70, 106 }, { 90, 75, 109 }, { 90, 80, 113 }, { 90, 85, 117 },
+  { 90, 90, 122 }, { 90, 95, 127 }, { 90, 100, 132 },
+  { 100, 40, 109 }, { 100, 45, 114 }, { 100, 50, 118 }, { 100, 55, 124 }, { 100, 60, 129 },
+  { 100, 65, 136 },
+  { 104, 40, 119 }, { 104, 45, 124 }, { 104, 50, 131 }, { 104, 55, 137 },
+};
+
+struct Sample {
+  unsigned long time;
+  float value;
+};
+
+// Brute-force view of RollingWindow<N>: buckets on the grid anchored at the
+// first sample, window = the N buckets ending with the newest sample's bucket.
+struct BruteWindow {
+  unsigned long bucketMs;
+  unsigned long maxStepMs;
+  size_t buckets;
+  std::vector<Sample> samples;
+
+  unsigned long bucket_of(unsigned long t) const { return (t - samples[0].time) / bucketMs; }
+
+  bool in_window(size_t i) const {
+    unsigned long current = bucket_of(samples.back().time);
+    return bucket_of(samples[i].time) + buckets > current;
+  }
+
+  float minimum() const {
+    float result = NAN;
+    for (size_t i = 0; i < samples.size(); i++) {
+      if (in_window(i) && (isnan(result) || samples[i].value < result)) result = samples[i].value;
+    }
+    return result;
+  }
+
+  float maximum() const {
+    float result = NAN;
+    for (size_t i = 0; i < samples.size(); i++) {
+      if (in_window(i) && (isnan(result) || samples[i].value > result)) result = samples[i].value;
+    }
+    return result;
+  }
+
+  // Trapezoidal time-weighted mean; steps longer than maxStepMs are outages and carry no weight
+  double mean() const {
+    double area = 0.0, duration = 0.0, sum = 0.0;
+    int count = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+      if (!in_window(i)) continue;
+      sum += samples[i].value;
+      count++;
+      if (i == 0) continue;
+      double dt = samples[i].time - samples[i - 1].time;
+      if (dt > maxStepMs) continue;
+      area += (samples[i - 1].value + (double)samples[i].value) / 2.0 * dt;
+      duration += dt;
+    }
+    if (duration > 0.0) return area / duration;
+    return count > 0 ? sum / count : NAN;
+  }
+
+  double bucket_mean(unsigned long bucket) const {
+    double sum = 0.0;
+    int count = 0;
+    for (const Sample& s : samples) {
+      if (bucket_of(s.time) == bucket) {
+        sum += s.value;
+        count++;
+      }
+    }
+    return count > 0 ? sum / count : NAN;
+  }
+
+  double change_over_window() const {
+    unsigned long current = bucket_of(samples.back().time);
+    if (current + 1 < buckets) return NAN;
+    long newest = -1, oldest = -1;
+    for (size_t ago = 0; ago < buckets; ago++) {
+      if (!isnan(bucket_mean(current - ago))) {
+        if (newest < 0) newest = ago;
+        oldest = ago;
+      }
+    }
+    if (newest < 0 || (size_t)(oldest - newest) < (buckets - 1) / 2) return NAN;
+    return (bucket_mean(current - newest) - bucket_mean(current - oldest)) * (double)(buckets - 1) / (oldest - newest);
+  }
+};
+
+// --- Dew Point ---
+
+void test_dew_point_known_value() {
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 16.69, dew_point_c(25.0, 60.0));
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 20.0, dew_point_c(20.0, 100.0)); // Saturated: dew point equals temperature
+}
+
+void test_dew_point_matches_saturation_reference() {
+  // At the dew point the saturation pressure equals the actual vapour pressure
+  for (float t = -30.0; t <= 50.0; t += 2.5) {
+    for (float rh = 5.0; rh <= 100.0; rh += 5.0) {
+      double actual = rh / 100.0 * ref_saturation_hpa(t);
+      double atDewPoint = ref_saturation_hpa(dew_point_c(t, rh));
+      TEST_ASSERT_DOUBLE_WITHIN(actual * 1e-4, actual, atDewPoint);
+    }
+  }
+}
+
+void test_dew_point_rejects_invalid_input() {
+  TEST_ASSERT_FLOAT_IS_NAN(dew_point_c(20.0, 0.0));
+  TEST_ASSERT_FLOAT_IS_NAN(dew_point_c(NAN, 50.0));
+  TEST_ASSERT_FLOAT_IS_NAN(dew_point_c(20.0, NAN));
+}
+
+// --- Heat Index ---
+
+void test_heat_index_simple_branch() {
+  // 0.5 * (70 + 61 + 2.4 + 4.7)
+  TEST_ASSERT_FLOAT_WITHIN(0.001, 69.05, heat_index_f(70.0, 50.0));
+}
+
+void test_heat_index_rothfusz_branch() {
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 94.60, heat_index_f(90.0, 50.0));
+}
+
+void test_heat_index_low_humidity_adjustment() {
+  double T = 100.0, RH = 10.0;
+  double rothfusz = -42.379 + 2.04901523 * T + 10.14333127 * RH - .22475541 * T * RH
+                    - .00683783 * T * T - .05481717 * RH * RH + .00122874 * T * T * RH
+                    + .00085282 * T * RH * RH - .00000199 * T * T * RH * RH;
+  double adjustment = ((13 - RH) / 4) * sqrt((17 - fabs(T - 95.)) / 17);
+  TEST_ASSERT_TRUE(adjustment > 0.5);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, rothfusz - adjustment, heat_index_f(T, RH));
+}
+
+void test_heat_index_high_humidity_adjustment() {
+  double T = 82.0, RH = 95.0;
+  double rothfusz = -42.379 + 2.04901523 * T + 10.14333127 * RH - .22475541 * T * RH
+                    - .00683783 * T * T - .05481717 * RH * RH + .00122874 * T * T * RH
+                    + .00085282 * T * RH * RH - .00000199 * T * T * RH * RH;
+  double adjustment = ((RH - 85) / 10) * ((87 - T) / 5);
+  TEST_ASSERT_TRUE(adjustment > 0.5);
+  TEST_ASSERT_FLOAT_WITHIN(0.01, rothfusz + adjustment, heat_index_f(T, RH));
+}
+
+void test_heat_index_switches_on_simple_formula() {
+  // The simple formula gives 80.8 here, so the regression takes over
+  TEST_ASSERT_FLOAT_WITHIN(0.05, 82.98, heat_index_f(79.0, 90.0));
+  // Simple formula below 80
+  TEST_ASSERT_FLOAT_WITHIN(0.01, 79.58, heat_index_f(80.0, 40.0));
+}
+
+void test_heat_index_matches_nws_chart() {
+  for (const HeatIndexCell& cell : NWS_HEAT_INDEX_CHART) {
+    // The chart is rounded to whole degrees
+    TEST_ASSERT_FLOAT_WITHIN(1.0, cell.heatIndexF, heat_index_f(cell.temperatureF, cell.humidity));
+  }
+}
+
+// --- Rolling Window ---
+
+const unsigned long BUCKET_MS = 30UL * 60 * 1000;
+// Matches temperatureDaily in derived_metrics.cpp: twice SAMPLE_BOUND_MAX_SEC
+const unsigned long MAX_INTERVAL_MS = 3600UL * 1000;
+const unsigned long MAX_STEP_MS = 2 * MAX_INTERVAL_MS;
+
+void test_window_empty() {
+  RollingWindow<48> window(BUCKET_MS);
+  TEST_ASSERT_TRUE(window.empty());
+  TEST_ASSERT_FLOAT_IS_NAN(window.minimum());
+  TEST_ASSERT_FLOAT_IS_NAN(window.maximum());
+  TEST_ASSERT_FLOAT_IS_NAN(window.mean());
+  TEST_ASSERT_FLOAT_IS_NAN(window.change_over_window());
+}
+
+void test_window_mean_is_time_weighted() {
+  // An hour at 0 sampled twice, then a minute at 10 sampled every second
+  RollingWindow<4> window(3600000UL);
+  window.add(0, 0.0);
+  window.add(3600000UL, 0.0);
+  for (int i = 1; i <= 60; i++) {
+    window.add(3600000UL + i * 1000UL, 10.0);
+  }
+  // (0.5 * 1 s + 59 s) * 10 / 3660 s; a per-sample mean would be 600 / 62 = 9.68
+  TEST_ASSERT_FLOAT_WITHIN(1e-4, 595000.0 / 3660000.0, window.mean());
+}
+
+void test_window_matches_brute_force() {
+  RollingWindow<48> window(BUCKET_MS, MAX_STEP_MS);
+  BruteWindow brute = { BUCKET_MS, MAX_STEP_MS, 48, {} };
+  srand(1);
+
+  unsigned long t = 1000;
+  for (int i = 0; i < 20000; i++) {
+    // Mostly the adaptive 5 s - 5 min cadence, with occasional steps
+    // longer than a bucket, outages, and outages longer than the window
+    int r = rand() % 1000;
+    if (r == 0) {
+      t += 30UL * 3600 * 1000;
+    } else if (r < 5) {
+      t += 3UL * 3600 * 1000 + rand() % 1000;
+    } else if (r < 15) {
+      t += 40UL * 60 * 1000 + rand() % 1000;
+    } else {
+      t += 5000 + rand() % 295000;
+    }
+    float value = (rand() % 10000) / 100.0;
+    window.add(t, value);
+    brute.samples.push_back({ t, value });
+
+    TEST_ASSERT_FLOAT_WITHIN(0.0, brute.minimum(), window.minimum());
+    TEST_ASSERT_FLOAT_WITHIN(0.0, brute.maximum(), window.maximum());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3, brute.mean(), window.mean());
+  }
+}
+
+void test_window_keeps_samples_at_max_interval() {
+  // A channel set to the maximum interval, each reading landing a little
+  // late, plus one short burst of fast readings
+  RollingWindow<48> window(BUCKET_MS, MAX_STEP_MS);
+  BruteWindow brute = { BUCKET_MS, MAX_STEP_MS, 48, {} };
+  unsigned long t = 1000;
+  for (int i = 0; i < 30; i++) {
+    window.add(t, 10.0);
+    brute.samples.push_back({ t, 10.0 });
+    for (int j = 0; i == 20 && j < 10; j++) {
+      t += 5000;
+      window.add(t, 30.0);
+      brute.samples.push_back({ t, 30.0 });
+    }
+    t += MAX_INTERVAL_MS + 80 + (i % 3) * 500;
+  }
+  // Dropping the hourly steps as outages would leave only the burst's 30s
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, brute.mean(), window.mean());
+  TEST_ASSERT_FLOAT_WITHIN(0.5, 10.0, window.mean());
+}
+
+void test_window_recovers_after_gap_longer_than_window() {
+  RollingWindow<48> window(BUCKET_MS, MAX_STEP_MS);
+  window.add(0, 50.0);
+  window.add(60000, 90.0);
+  window.add(48UL * 3600 * 1000, 10.0);
+  TEST_ASSERT_FLOAT_WITHIN(0.0, 10.0, window.minimum());
+  TEST_ASSERT_FLOAT_WITHIN(0.0, 10.0, window.maximum());
+  TEST_ASSERT_FLOAT_WITHIN(0.0, 10.0, window.mean());
+}
+
+// --- Pressure Tendency ---
+
+const unsigned long TREND_BUCKET_MS = 15UL * 60 * 1000;
+
+void test_tendency_needs_full_window() {
+  RollingWindow<13> window(TREND_BUCKET_MS);
+  for (unsigned long t = 0; t < 11UL * TREND_BUCKET_MS; t += 60000) {
+    window.add(t, 1000.0);
+  }
+  TEST_ASSERT_FLOAT_IS_NAN(window.change_over_window());
+}
+
+void test_tendency_with_sparse_samples() {
+  // 1 hPa/h sampled once an hour (the maximum pressure interval) leaves most
+  // 15 minute buckets empty; the tendency must still come out as 3 hPa/3 h
+  RollingWindow<13> window(TREND_BUCKET_MS);
+  for (unsigned long h = 0; h <= 6; h++) {
+    window.add(h * 3600000UL, 1000.0 + h);
+  }
+  TEST_ASSERT_FLOAT_WITHIN(1e-3, 3.0, window.change_over_window());
+}
+
+void test_tendency_matches_brute_force() {
+  RollingWindow<13> window(TREND_BUCKET_MS);
+  BruteWindow brute = { TREND_BUCKET_MS, TREND_BUCKET_MS, 13, {} };
+  srand(2);
+
+  unsigned long t = 0;
+  float pressure = 1013.0;
+  for (int i = 0; i < 5000; i++) {
+    int r = rand() % 500;
+    if (r == 0) {
+      t += 4UL * 3600 * 1000; // Outage longer than the window
+    } else {
+      t += 10000 + rand() % 3590000; // 10 s - 1 h
+    }
+    pressure += ((rand() % 200) - 100) / 100.0;
+    window.add(t, pressure);
+    brute.samples.push_back({ t, pressure });
+
+    double expected = brute.change_over_window();
+    float actual = window.change_over_window();
+    if (isnan(expected)) {
+      TEST_ASSERT_FLOAT_IS_NAN(actual);
+    } else {
+      TEST_ASSERT_FLOAT_WITHIN(1e-2, expected, actual);
+    }
+  }
+}
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(test_dew_point_known_value);
+  RUN_TEST(test_dew_point_matches_saturation_reference);
+  RUN_TEST(test_dew_point_rejects_invalid_input);
+  RUN_TEST(test_heat_index_simple_branch);
+  RUN_TEST(test_heat_index_rothfusz_branch);
+  RUN_TEST(test_heat_index_low_humidity_adjustment);
+  RUN_TEST(test_heat_index_high_humidity_adjustment);
+  RUN_TEST(test_heat_index_switches_on_simple_formula);
+  RUN_TEST(test_heat_index_matches_nws_chart);
+  RUN_TEST(test_window_empty);
+  RUN_TEST(test_window_mean_is_time_weighted);
+  RUN_TEST(test_window_matches_brute_force);
+  RUN_TEST(test_window_keeps_samples_at_max_interval);
+  RUN_TEST(test_window_recovers_after_gap_longer_than_window);
+  RUN_TEST(test_tendency_needs_full_window);
+  RUN_TEST(test_tendency_with_sparse_samples);
+  RUN_TEST(test_tendency_matches_brute_force);
+  return UNITY_END();
+}